@@ -27,11 +27,54 @@ void Config::initialize(const std::string& filename) {
         database_.name = pt.get<std::string>("DataBase.name");
         database_.login = pt.get<std::string>("DataBase.login");
         database_.pass = pt.get<std::string>("DataBase.pass");
+        database_.poolSize = pt.get<size_t>("DataBase.poolSize", database_.poolSize);
+        database_.acquireTimeout = pt.get<int>("DataBase.acquireTimeout", database_.acquireTimeout);
+        database_.healthCheckInterval = pt.get<int>("DataBase.healthCheckInterval", database_.healthCheckInterval);
 
         spider_.mainLink = pt.get<std::string>("Spider.main");
         spider_.depth = pt.get<std::string>("Spider.depth");
+        spider_.incremental = pt.get<bool>("Spider.incremental", spider_.incremental);
+        spider_.workers = pt.get<size_t>("Spider.workers", spider_.workers);
+        spider_.indexWorkers = pt.get<size_t>("Spider.indexWorkers", spider_.indexWorkers);
+        spider_.linkWorkers = pt.get<size_t>("Spider.linkWorkers", spider_.linkWorkers);
+        spider_.queueCapacity = pt.get<size_t>("Spider.queueCapacity", spider_.queueCapacity);
+        spider_.statsInterval = pt.get<int>("Spider.statsInterval", spider_.statsInterval);
+        spider_.batchSize = pt.get<size_t>("Spider.batchSize", spider_.batchSize);
+        spider_.flushInterval = pt.get<int>("Spider.flushInterval", spider_.flushInterval);
+        spider_.ioThreads = pt.get<size_t>("Spider.ioThreads", spider_.ioThreads);
+        spider_.maxInFlight = pt.get<size_t>("Spider.maxInFlight", spider_.maxInFlight);
+        spider_.hostConnections = pt.get<size_t>("Spider.hostConnections", spider_.hostConnections);
+        spider_.hostDelay = pt.get<int>("Spider.hostDelay", spider_.hostDelay);
+        spider_.maxHostDelay = pt.get<int>("Spider.maxHostDelay", spider_.maxHostDelay);
+        spider_.throttleRetries = pt.get<size_t>("Spider.throttleRetries", spider_.throttleRetries);
+        spider_.fetchTimeout = pt.get<int>("Spider.fetchTimeout", spider_.fetchTimeout);
+        spider_.maxIdlePerHost = pt.get<size_t>("Spider.maxIdlePerHost", spider_.maxIdlePerHost);
+        spider_.idleTimeout = pt.get<int>("Spider.idleTimeout", spider_.idleTimeout);
+        spider_.dnsTtl = pt.get<int>("Spider.dnsTtl", spider_.dnsTtl);
+        spider_.dnsNegativeTtl = pt.get<int>("Spider.dnsNegativeTtl", spider_.dnsNegativeTtl);
+        spider_.dnsStub = pt.get<std::string>("Spider.dnsStub", spider_.dnsStub);
+        spider_.maxPageSize = pt.get<size_t>("Spider.maxPageSize", spider_.maxPageSize);
+        spider_.maxCompressionRatio = pt.get<size_t>("Spider.maxCompressionRatio", spider_.maxCompressionRatio);
+        spider_.frontierCapacity = pt.get<size_t>("Spider.frontierCapacity", spider_.frontierCapacity);
+        spider_.frontierExactLimit = pt.get<size_t>("Spider.frontierExactLimit", spider_.frontierExactLimit);
+        spider_.duplicateDistance = pt.get<int>("Spider.duplicateDistance", spider_.duplicateDistance);
 
         server_.port = pt.get<std::string>("Server.port");
+        server_.threads = pt.get<size_t>("Server.threads", server_.threads);
+        server_.reusePort = pt.get<bool>("Server.reusePort", server_.reusePort);
+        server_.requestTimeout = pt.get<int>("Server.requestTimeout", server_.requestTimeout);
+        server_.maxRequestsPerConnection = pt.get<size_t>("Server.maxRequestsPerConnection", server_.maxRequestsPerConnection);
+        server_.cacheSize = pt.get<size_t>("Server.cacheSize", server_.cacheSize);
+        server_.cacheShards = pt.get<size_t>("Server.cacheShards", server_.cacheShards);
+        server_.epochPollInterval = pt.get<int>("Server.epochPollInterval", server_.epochPollInterval);
+
+        index_.engine = pt.get<std::string>("Index.engine", index_.engine);
+        index_.path = pt.get<std::string>("Index.path", index_.path);
+        index_.memoryBudget = pt.get<size_t>("Index.memoryBudget", index_.memoryBudget);
+        index_.flushInterval = pt.get<int>("Index.flushInterval", index_.flushInterval);
+        index_.mergeFactor = pt.get<size_t>("Index.mergeFactor", index_.mergeFactor);
+        index_.bm25K1 = pt.get<double>("Index.bm25K1", index_.bm25K1);
+        index_.bm25B = pt.get<double>("Index.bm25B", index_.bm25B);
     }
     catch (const boost::property_tree::ini_parser_error& e) {
         std::cerr << "   INI-: " << e.what() << std::endl;
@@ -15,17 +15,63 @@ public:
         std::string name;
         std::string login;
         std::string pass;
+        size_t poolSize = 8;           //    
+        int acquireTimeout = 5;        //    ()
+        int healthCheckInterval = 30;  // ,       ()
     };
 
     //  ("")
     struct Spider {
         std::string mainLink;
         std::string depth;
+        bool incremental = true;    //  :     
+        size_t workers = 0;         //    (0 -   )
+        size_t indexWorkers = 1;    //     
+        size_t linkWorkers = 1;     //      
+        size_t queueCapacity = 256; //     
+        int statsInterval = 10;     //     (, 0 -   )
+        size_t batchSize = 64;      //        
+        int flushInterval = 1000;   //     ()
+        size_t ioThreads = 2;       //  - 
+        size_t maxInFlight = 256;   //   
+        size_t hostConnections = 2; //     
+        int hostDelay = 200;        //       ()
+        int maxHostDelay = 60;      //      429/503  Retry-After ()
+        size_t throttleRetries = 3; //  ,     429/503
+        int fetchTimeout = 30;      //    ,      ()
+        size_t maxIdlePerHost = 8;  //      
+        int idleTimeout = 30;       //     ()
+        int dnsTtl = 300;           //       ()
+        int dnsNegativeTtl = 30;    // ,       ()
+        std::string dnsStub;        //  "=[,];..."    ( )
+        size_t maxPageSize = 4 * 1024 * 1024;  //    (),   
+        size_t maxCompressionRatio = 100;  //     (   )
+        size_t frontierCapacity = 1000000;  //    (   )
+        size_t frontierExactLimit = 4000000;  //  ,    
+        int duplicateDistance = 3;  //     SimHash    (-1 -  )
     };
 
     //  ()
     struct Server {
         std::string port;
+        size_t threads = 0;      //  - (0 -   )
+        bool reusePort = true;   //       SO_REUSEPORT,   
+        int requestTimeout = 60;  //        ()
+        size_t maxRequestsPerConnection = 100;  //     
+        size_t cacheSize = 64 * 1024 * 1024;  //     ()
+        size_t cacheShards = 16;              //     
+        int epochPollInterval = 1000;         //       ()
+    };
+
+    //  
+    struct Index {
+        std::string engine = "postgres";  // postgres -  frequency, native -    
+        std::string path = "../index";    //  ,     
+        size_t memoryBudget = 64 * 1024 * 1024;  //    ,       ()
+        int flushInterval = 30;           //    ():      
+        size_t mergeFactor = 4;           //        
+        double bm25K1 = 1.2;              //      BM25
+        double bm25B = 0.75;              //       BM25
     };
 
 private:
@@ -37,6 +83,7 @@ private:
     DataBase database_;
     Spider spider_;
     Server server_;
+    Index index_;
 
 public:
 
@@ -50,6 +97,7 @@ public:
     const DataBase& getDataBaseSettings() const { return database_; }
     const Spider& getSpiderSettings() const { return spider_; }
     const Server& getServerSettings() const { return server_; }
+    const Index& getIndexSettings() const { return index_; }
 
     //     
     Config(const Config&) = delete;
@@ -0,0 +1,129 @@
+#include "DB_pool.h"
+
+#include <stdexcept>
+
+DB_Pool::Lease::Lease(DB_Pool* pool, std::unique_ptr<pqxx::connection> connection)
+    : pool_(pool), connection_(std::move(connection)) {
+}
+
+DB_Pool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), connection_(std::move(other.connection_)) {
+    other.pool_ = nullptr;
+}
+
+DB_Pool::Lease& DB_Pool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (pool_ && connection_) {
+            pool_->release(std::move(connection_));
+        }
+        pool_ = other.pool_;
+        connection_ = std::move(other.connection_);
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+DB_Pool::Lease::~Lease() {
+    if (pool_ && connection_) {
+        pool_->release(std::move(connection_));
+    }
+}
+
+DB_Pool::DB_Pool(const Config::DataBase& db, SessionSetup setup)
+    : setup_(std::move(setup)),
+    maxSize_(db.poolSize > 0 ? db.poolSize : 1),
+    acquireTimeout_(db.acquireTimeout),
+    healthCheckInterval_(db.healthCheckInterval) {
+    connection_string = "dbname=" + db.name +
+        " user=" + db.login +
+        " password=" + db.pass +
+        " host=" + db.host +
+        " port=" + db.port;
+}
+
+DB_Pool::~DB_Pool() {
+    std::lock_guard<std::mutex> lock(m_);
+    idle_.clear();
+}
+
+std::unique_ptr<pqxx::connection> DB_Pool::openDirect() {
+    auto connection = std::make_unique<pqxx::connection>(connection_string);
+    if (!connection->is_open()) {
+        throw std::runtime_error("CONNECTION ERROR");
+    }
+    return connection;
+}
+
+std::unique_ptr<pqxx::connection> DB_Pool::connect() {
+    auto connection = openDirect();
+    //         
+    if (setup_) {
+        setup_(*connection);
+    }
+    return connection;
+}
+
+bool DB_Pool::healthy(pqxx::connection& connection) {
+    if (!connection.is_open()) {
+        return false;
+    }
+    try {
+        pqxx::nontransaction ping(connection);
+        ping.exec("SELECT 1;");
+        return true;
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+DB_Pool::Lease DB_Pool::acquire() {
+    Idle idle;
+    {
+        std::unique_lock<std::mutex> lock(m_);
+        bool ready = cv_.wait_for(lock, acquireTimeout_, [this] {
+            return !idle_.empty() || open_ < maxSize_;
+            });
+        if (!ready) {
+            throw std::runtime_error("    ");
+        }
+
+        if (!idle_.empty()) {
+            idle = std::move(idle_.back()); //    -  ""
+            idle_.pop_back();
+        }
+        else {
+            open_++;
+        }
+    }
+
+    try {
+        //      :   
+        if (idle.connection && std::chrono::steady_clock::now() - idle.since >= healthCheckInterval_
+            && !healthy(*idle.connection)) {
+            idle.connection.reset();
+        }
+        if (!idle.connection) {
+            idle.connection = connect();
+        }
+    }
+    catch (...) {
+        release(nullptr);
+        throw;
+    }
+
+    return Lease(this, std::move(idle.connection));
+}
+
+void DB_Pool::release(std::unique_ptr<pqxx::connection> connection) {
+    {
+        std::lock_guard<std::mutex> lock(m_);
+        if (!connection || !connection->is_open()) {
+            open_--; //  :    ,    
+        }
+        else {
+            idle_.push_back({std::move(connection), std::chrono::steady_clock::now()});
+        }
+    }
+    cv_.notify_one();
+}
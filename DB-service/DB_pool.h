@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <pqxx/pqxx>
+#include "../Config/config.h"
+
+//     Postgres,     .
+//     (  poolSize),  
+//     ,   
+class DB_Pool {
+public:
+	using SessionSetup = std::function<void(pqxx::connection&)>;
+
+	//  :     
+	class Lease {
+	public:
+		Lease() = default;
+		Lease(Lease&& other) noexcept;
+		Lease& operator=(Lease&& other) noexcept;
+		~Lease();
+
+		pqxx::connection& operator*() const { return *connection_; }
+		pqxx::connection* operator->() const { return connection_.get(); }
+
+	private:
+		friend class DB_Pool;
+		Lease(DB_Pool* pool, std::unique_ptr<pqxx::connection> connection);
+
+		DB_Pool* pool_ = nullptr;
+		std::unique_ptr<pqxx::connection> connection_;
+	};
+
+	DB_Pool(const Config::DataBase& db, SessionSetup setup);
+	~DB_Pool();
+
+	//      acquireTimeout,   
+	Lease acquire();
+
+	//        : ,   ,
+	//     
+	std::unique_ptr<pqxx::connection> openDirect();
+
+	DB_Pool(const DB_Pool&) = delete;
+	DB_Pool& operator=(const DB_Pool&) = delete;
+
+private:
+	struct Idle {
+		std::unique_ptr<pqxx::connection> connection;
+		std::chrono::steady_clock::time_point since;
+	};
+
+	std::string connection_string;
+	SessionSetup setup_;
+	const size_t maxSize_;
+	const std::chrono::seconds acquireTimeout_;
+	const std::chrono::seconds healthCheckInterval_;
+
+	std::mutex m_;
+	std::condition_variable cv_;
+	std::vector<Idle> idle_;
+	size_t open_ = 0;  //    
+
+	std::unique_ptr<pqxx::connection> connect();
+	bool healthy(pqxx::connection& connection);
+	void release(std::unique_ptr<pqxx::connection> connection);
+};
@@ -1,35 +1,26 @@
 #include "DB_service.h"
 
-DB_Handle::DB_Handle(const Config::DataBase& db) {
-    connection_string = "dbname=" + db.name +
-        " user=" + db.login +
-        " password=" + db.pass +
-        " host=" + db.host +
-        " port=" + db.port;
+namespace {
 
-    try {
-        connection = new pqxx::connection(connection_string);
-        if (connection->is_open()) {
-            initialize();
-            //std::cout << "CONNECTION OK" << std::endl;
-        }
-        else {
-            std::cerr << "CONNECTION ERROR" << std::endl;
-        }
-    } catch (const std::exception& e) {
-        std::cerr << e.what() << std::endl;
-    }
+constexpr size_t wordCacheShards = 16;
+
+}
+
+//          ,  
+//    :         
+DB_Handle::DB_Handle(const Config::DataBase& db)
+    : pool(db, &DB_Handle::prepareSession), words(pool, wordCacheShards) {
+    initialize();
 }
 
 DB_Handle::~DB_Handle() {
-    std::lock_guard<std::mutex> lock(dbMutex);
-	delete connection;
 }
 
+//      ,     .  
+//   :       ,      
 void DB_Handle::initialize() {
 
-    std::lock_guard<std::mutex> lock(dbMutex);
-
+    auto connection = pool.openDirect();
     pqxx::work work(*connection);
 
     work.exec("CREATE TABLE IF NOT EXISTS links (id INT GENERATED ALWAYS AS IDENTITY PRIMARY KEY, url VARCHAR UNIQUE NOT NULL);");
@@ -38,7 +29,40 @@ void DB_Handle::initialize() {
         "word_id INT REFERENCES words(id), count INT NOT NULL, "
         "UNIQUE (link_id, word_id));");
 
-    connection->prepare("get_specific_word_frequency",
+    //     :      
+    work.exec("CREATE TABLE IF NOT EXISTS page_state (link_id INT PRIMARY KEY REFERENCES links(id), "
+        "etag VARCHAR NOT NULL, last_modified VARCHAR NOT NULL, content_hash BIGINT NOT NULL, "
+        "depth INT NOT NULL, crawled_at TIMESTAMPTZ NOT NULL, fingerprint BIGINT NOT NULL DEFAULT 0);");
+    work.exec("ALTER TABLE page_state ADD COLUMN IF NOT EXISTS fingerprint BIGINT NOT NULL DEFAULT 0;");
+
+    //  :        
+    work.exec("CREATE TABLE IF NOT EXISTS page_alias (url VARCHAR PRIMARY KEY, canonical_url VARCHAR NOT NULL);");
+
+    //  :     ,      
+    work.exec("CREATE TABLE IF NOT EXISTS crawl_state (id INT PRIMARY KEY CHECK (id = 1), epoch BIGINT NOT NULL);");
+    work.exec("INSERT INTO crawl_state (id, epoch) VALUES (1, 0) ON CONFLICT (id) DO NOTHING;");
+    // ,      :      postgres
+    work.exec("ALTER TABLE crawl_state ADD COLUMN IF NOT EXISTS engine VARCHAR NOT NULL DEFAULT 'postgres';");
+    //    : ,  ,    
+    work.exec("ALTER TABLE crawl_state ADD COLUMN IF NOT EXISTS started_at TIMESTAMPTZ;");
+
+    work.commit();
+
+    //std::cout << "Tables created!" << std::endl;
+}
+
+//    : ,     
+void DB_Handle::prepareSession(pqxx::connection& connection) {
+
+    pqxx::work work(connection);
+
+    //       COPY
+    work.exec("CREATE TEMP TABLE IF NOT EXISTS staging_frequency (url VARCHAR NOT NULL, "
+        "word_id INT NOT NULL, count INT NOT NULL) ON COMMIT DELETE ROWS;");
+
+    work.commit();
+
+    connection.prepare("get_specific_word_frequency",
         "SELECT url, SUM(f.count) as sum_words "
         "FROM frequency f "
         "JOIN words w ON f.word_id = w.id "
@@ -47,14 +71,10 @@ void DB_Handle::initialize() {
         "GROUP BY url "
         "ORDER BY sum_words DESC "
         "LIMIT 10;");
-
-    work.commit();
-
-    //std::cout << "Tables created!" << std::endl;
 }
 
 int DB_Handle::add_link(const std::string& url) {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    auto connection = pool.acquire();
     pqxx::work work(*connection);
     try {
         std::string insert_query = R"(
@@ -82,7 +102,7 @@ int DB_Handle::add_link(const std::string& url) {
 }
 
 int DB_Handle::add_word(const std::string& word) {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    auto connection = pool.acquire();
     pqxx::work work(*connection); 
     try {
         std::string insert_query = R"(
@@ -110,7 +130,7 @@ int DB_Handle::add_word(const std::string& word) {
 }
 
 void DB_Handle::add_frequency(int link_id, int word_id, int frequency) {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    auto connection = pool.acquire();
     pqxx::work work(*connection);  //   
 
     try {
@@ -136,13 +156,323 @@ void DB_Handle::add_frequency(int link_id, int word_id, int frequency) {
 
 }
 
-std::vector<std::string> DB_Handle::get_query_result(const std::vector<std::string>& words) {
-    std::lock_guard<std::mutex> lock(dbMutex);
+//    ,   .   :
+//        .
+//       :  ,   ,
+//   ,  ,    
+void DB_Handle::add_pages(const std::vector<PageWords>& pages) {
+    if (pages.empty()) {
+        return;
+    }
+
+    std::vector<std::string> replaced;
+    for (const auto& page : pages) {
+        if (!page.unchanged) {
+            replaced.push_back(page.url);
+        }
+    }
+
+    // id     :      ,    
+    std::vector<std::string> pageWords;
+    for (const auto& page : pages) {
+        for (const auto& entry : page.wordsCount) {
+            pageWords.push_back(entry.first);
+        }
+    }
+    std::vector<int> wordIds;
+    words.resolve(pageWords, wordIds);
+
+    auto connection = pool.acquire();
+    pqxx::work work(*connection);
+
+    //       
+    auto stream = pqxx::stream_to::table(work, {"staging_frequency"}, {"url", "word_id", "count"});
+    size_t next = 0;
+    for (const auto& page : pages) {
+        for (const auto& entry : page.wordsCount) {
+            stream.write_values(page.url, wordIds[next++], entry.second);
+        }
+    }
+    stream.complete();
+
+    work.exec_params(R"(
+        DELETE FROM frequency f
+        USING links l
+        WHERE f.link_id = l.id AND l.url = ANY($1);
+    )", replaced);
+
+    //     :     
+    work.exec(R"(
+        INSERT INTO links (url)
+        SELECT DISTINCT url FROM staging_frequency
+        ORDER BY url
+        ON CONFLICT (url) DO NOTHING;
+    )");
+
+    work.exec(R"(
+        INSERT INTO frequency (link_id, word_id, count)
+        SELECT l.id, s.word_id, MAX(s.count)
+        FROM staging_frequency s
+        JOIN links l ON l.url = s.url
+        GROUP BY l.id, s.word_id
+        ON CONFLICT (link_id, word_id)
+        DO UPDATE SET count = EXCLUDED.count;
+    )");
+
+    work.exec("UPDATE crawl_state SET epoch = epoch + 1 WHERE id = 1;");
+
+    work.commit();
+}
+
+//        :     
+std::vector<int> DB_Handle::add_documents(const std::vector<PageWords>& pages) {
+    std::vector<std::string> urls;
+    urls.reserve(pages.size());
+    for (const auto& page : pages) {
+        urls.push_back(page.url);
+    }
+
+    auto connection = pool.acquire();
+    pqxx::work work(*connection);
+
+    work.exec_params(R"(
+        INSERT INTO links (url)
+        SELECT DISTINCT unnest($1::varchar[])
+        ON CONFLICT (url) DO NOTHING;
+    )", urls);
+    pqxx::result rows = work.exec_params("SELECT id, url FROM links WHERE url = ANY($1);", urls);
+    work.commit();
+
+    std::unordered_map<std::string, int> idByUrl;
+    for (const auto& row : rows) {
+        idByUrl[row["url"].as<std::string>()] = row["id"].as<int>();
+    }
+
+    std::vector<int> ids;
+    ids.reserve(pages.size());
+    for (const auto& url : urls) {
+        auto it = idByUrl.find(url);
+        ids.push_back(it != idByUrl.end() ? it->second : -1);
+    }
+    return ids;
+}
+
+//   ,  ,  :    .  
+//    : add_pages     ,  
+//        .    :
+//       . ,   add_pages,  
+void DB_Handle::save_page_states(const std::vector<PageWords>& pages) {
+    if (pages.empty()) {
+        return;
+    }
+
+    std::vector<std::string> urls, etags, lastModified, canonical;
+    std::vector<int64_t> hashes, fingerprints;
+    std::vector<int> depths;
+    for (const auto& page : pages) {
+        urls.push_back(page.url);
+        etags.push_back(page.state.etag);
+        lastModified.push_back(page.state.lastModified);
+        hashes.push_back(static_cast<int64_t>(page.state.contentHash));
+        depths.push_back(page.state.depth);
+        fingerprints.push_back(static_cast<int64_t>(page.state.fingerprint));
+        canonical.push_back(page.state.canonicalUrl);
+    }
+
+    auto connection = pool.acquire();
+    pqxx::work work(*connection);
+
+    //   ,   add_pages:       
+    work.exec_params(R"(
+        INSERT INTO links (url)
+        SELECT DISTINCT u FROM unnest($1::varchar[]) AS u
+        ORDER BY u
+        ON CONFLICT (url) DO NOTHING;
+    )", urls);
+    work.exec_params(R"(
+        INSERT INTO page_state (link_id, etag, last_modified, content_hash, depth, crawled_at, fingerprint)
+        SELECT DISTINCT ON (l.id) l.id, s.etag, s.last_modified, s.content_hash, s.depth, now(), s.fingerprint
+        FROM unnest($1::varchar[], $2::varchar[], $3::varchar[], $4::bigint[], $5::int[], $6::bigint[])
+            AS s(url, etag, last_modified, content_hash, depth, fingerprint)
+        JOIN links l ON l.url = s.url
+        ORDER BY l.id
+        ON CONFLICT (link_id) DO UPDATE SET etag = EXCLUDED.etag, last_modified = EXCLUDED.last_modified,
+            content_hash = EXCLUDED.content_hash, depth = EXCLUDED.depth, crawled_at = EXCLUDED.crawled_at,
+            fingerprint = EXCLUDED.fingerprint;
+    )", urls, etags, lastModified, hashes, depths, fingerprints);
+
+    work.exec_params("DELETE FROM page_alias WHERE url = ANY($1);", urls);
+    work.exec_params(R"(
+        INSERT INTO page_alias (url, canonical_url)
+        SELECT DISTINCT ON (a.url) a.url, a.canonical_url
+        FROM unnest($1::varchar[], $2::varchar[]) AS a(url, canonical_url)
+        WHERE a.canonical_url <> ''
+        ORDER BY a.url;
+    )", urls, canonical);
+    work.commit();
+}
+
+//    :       
+std::unordered_map<std::string, PageState> DB_Handle::get_page_states() {
+    auto connection = pool.acquire();
+    pqxx::nontransaction work(*connection);
+    pqxx::result rows = work.exec(R"(
+        SELECT l.url, p.etag, p.last_modified, p.content_hash, p.depth, p.fingerprint,
+            COALESCE(a.canonical_url, '') AS canonical_url
+        FROM page_state p
+        JOIN links l ON l.id = p.link_id
+        LEFT JOIN page_alias a ON a.url = l.url;
+    )");
+
+    std::unordered_map<std::string, PageState> states;
+    states.reserve(rows.size());
+    for (const auto& row : rows) {
+        PageState& state = states[row["url"].as<std::string>()];
+        state.etag = row["etag"].as<std::string>();
+        state.lastModified = row["last_modified"].as<std::string>();
+        state.contentHash = static_cast<uint64_t>(row["content_hash"].as<int64_t>());
+        state.depth = row["depth"].as<int>();
+        state.fingerprint = static_cast<uint64_t>(row["fingerprint"].as<int64_t>());
+        state.canonicalUrl = row["canonical_url"].as<std::string>();
+    }
+    return states;
+}
+
+//      ,     
+//   ,  ,   HTML    .
+//           .   
+//    ( frequency):     .
+//          
+std::vector<int> DB_Handle::expire_page_states() {
+    auto connection = pool.acquire();
+    pqxx::work work(*connection);
+    pqxx::result rows = work.exec(R"(
+        DELETE FROM page_state p
+        USING crawl_state c
+        WHERE c.id = 1 AND p.crawled_at < c.started_at
+        RETURNING p.link_id;
+    )");
+    std::vector<int> ids;
+    for (const auto& row : rows) {
+        ids.push_back(row[0].as<int>());
+    }
+    if (!ids.empty()) {
+        work.exec_params("DELETE FROM page_alias a USING links l WHERE l.url = a.url AND l.id = ANY($1);", ids);
+        work.exec_params("DELETE FROM frequency WHERE link_id = ANY($1);", ids);
+        work.exec("UPDATE crawl_state SET epoch = epoch + 1 WHERE id = 1;"); //     
+    }
+    work.commit();
+    return ids;
+}
+
+//       (  )
+std::vector<std::string> DB_Handle::get_urls(const std::vector<int>& ids) {
+    std::vector<std::string> urls;
+    if (ids.empty()) {
+        return urls;
+    }
+
+    auto connection = pool.acquire();
+    pqxx::nontransaction work(*connection);
+    pqxx::result rows = work.exec_params("SELECT id, url FROM links WHERE id = ANY($1);", ids);
+
+    std::unordered_map<int, std::string> urlById;
+    for (const auto& row : rows) {
+        urlById[row["id"].as<int>()] = row["url"].as<std::string>();
+    }
+    for (int id : ids) {
+        auto it = urlById.find(id);
+        if (it != urlById.end()) {
+            urls.push_back(std::move(it->second));
+        }
+    }
+    return urls;
+}
+
+void DB_Handle::preload_words() {
+    words.preload();
+}
+
+TermDictionary::Stats DB_Handle::word_cache_stats() const {
+    return words.stats();
+}
+
+void DB_Handle::bump_crawl_epoch() {
+    auto connection = pool.acquire();
+    pqxx::nontransaction work(*connection);
+    work.exec("UPDATE crawl_state SET epoch = epoch + 1 WHERE id = 1;");
+}
+
+int64_t DB_Handle::get_crawl_epoch() {
+    auto connection = pool.acquire();
+    pqxx::nontransaction work(*connection);
+    pqxx::result result = work.exec("SELECT epoch FROM crawl_state WHERE id = 1;");
+    return result.empty() ? 0 : result[0][0].as<int64_t>();
+}
+
+std::string DB_Handle::get_index_engine() {
+    auto connection = pool.acquire();
+    pqxx::nontransaction work(*connection);
+    pqxx::result result = work.exec("SELECT engine FROM crawl_state WHERE id = 1;");
+    return result.empty() ? "postgres" : result[0][0].as<std::string>();
+}
+
+std::string DB_Handle::start_crawl() {
+    auto connection = pool.acquire();
+    pqxx::nontransaction work(*connection);
+    return work.exec("SELECT now()::text;")[0][0].as<std::string>();
+}
+
+void DB_Handle::finish_crawl(const std::string& started, const std::string& engine) {
+    auto connection = pool.acquire();
+    pqxx::nontransaction work(*connection);
+    work.exec_params("UPDATE crawl_state SET started_at = $1::timestamptz, engine = $2 WHERE id = 1;", started, engine);
+}
+
+void QueryCancel::cancel() {
+    std::lock_guard<std::mutex> lock(m_);
+    cancelled_ = true;
+    if (running_) {
+        running_->cancel_query(); //       
+    }
+}
+
+bool QueryCancel::cancelled() {
+    std::lock_guard<std::mutex> lock(m_);
+    return cancelled_;
+}
+
+bool QueryCancel::attach(pqxx::connection* connection) {
+    std::lock_guard<std::mutex> lock(m_);
+    running_ = connection;
+    return !cancelled_;
+}
+
+void QueryCancel::detach() {
+    std::lock_guard<std::mutex> lock(m_);
+    running_ = nullptr;
+}
+
+std::vector<std::string> DB_Handle::get_query_result(const std::vector<std::string>& words, QueryCancel* cancel) {
     //     
     std::vector<std::string> res_;
 
+    if (cancel && cancel->cancelled()) {
+        return res_; //  ,    
+    }
+
+    auto connection = pool.acquire();
+    //         
+    struct Detach {
+        QueryCancel* cancel;
+        ~Detach() { if (cancel) cancel->detach(); }
+    } detach{cancel};
+
+    if (cancel && !cancel->attach(&*connection)) {
+        return res_;
+    }
+
     pqxx::work work(*connection);
-    pqxx::array<std::string> word_array();
     try {
         pqxx::result result = work.exec_prepared("get_specific_word_frequency", words);
 
@@ -153,8 +483,13 @@ std::vector<std::string> DB_Handle::get_query_result(const std::vector<std::stri
 
         work.commit();
     }
-    catch (const std::exception& e) {
-        std::cout << e.what() << std::endl;
+    catch (const std::exception&) {
+        //     :   ,   .
+        //    ,       
+        if (!cancel || !cancel->cancelled()) {
+            throw;
+        }
+        res_.clear();
     }
 
     return res_;
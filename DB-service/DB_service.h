@@ -2,10 +2,57 @@
 
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 #include <mutex>
 #include <pqxx/pqxx>
+#include "DB_pool.h"
+#include "term_dictionary.h"
 #include "../Config/config.h"
 
+//     :  HTTP-,  
+//  ,     (       )
+struct PageState {
+	std::string etag;
+	std::string lastModified;
+	uint64_t contentHash = 0;
+	int depth = 0;
+	uint64_t fingerprint = 0;   // SimHash       (0 - )
+	std::string canonicalUrl;   //   -        
+};
+
+//  :    .
+//         ( -  )
+struct PageWords {
+	std::string url;
+	std::unordered_map<std::string, int> wordsCount;
+	std::unordered_map<std::string, std::vector<uint32_t>> positions;
+	PageState state;
+	bool unchanged = false;  //      :  ,   
+
+	//     :       
+	bool indexable() const { return !unchanged && state.canonicalUrl.empty(); }
+};
+
+//     :      ,
+//     
+class QueryCancel {
+public:
+	void cancel();
+	bool cancelled();
+
+private:
+	friend class DB_Handle;
+
+	bool attach(pqxx::connection* connection);
+	void detach();
+
+	std::mutex m_;
+	pqxx::connection* running_ = nullptr;
+	bool cancelled_ = false;
+};
+
+//     .    :  ,
+//       
 class DB_Handle {
 public:
 	DB_Handle(const Config::DataBase& db);
@@ -14,14 +61,34 @@ public:
 	int add_link(const std::string& url);
 	int add_word(const std::string& word);
 	void add_frequency(int link_id, int word_id, int frequency);
-	std::vector<std::string> get_query_result(const std::vector<std::string>& words);
+	void add_pages(const std::vector<PageWords>& pages);
+	std::vector<int> add_documents(const std::vector<PageWords>& pages);
+	void save_page_states(const std::vector<PageWords>& pages);
+	std::unordered_map<std::string, PageState> get_page_states();
+	//     ,       ;   
+	std::vector<int> expire_page_states();
+	std::vector<std::string> get_urls(const std::vector<int>& ids);
+	void bump_crawl_epoch();
+	//    ;     
+	std::vector<std::string> get_query_result(const std::vector<std::string>& words, QueryCancel* cancel = nullptr);
+	int64_t get_crawl_epoch();
+	//   (engine  [Index]),    
+	std::string get_index_engine();
+	//      ,     crawled_at
+	std::string start_crawl();
+	//  :      
+	void finish_crawl(const std::string& started, const std::string& engine);
+
+	//  id   add_pages:     
+	void preload_words();
+	TermDictionary::Stats word_cache_stats() const;
 
 	void commit();
 
 private:
-	std::string connection_string;
-	pqxx::connection* connection = nullptr;
-	std::mutex dbMutex;
+	DB_Pool pool;
+	TermDictionary words;
 
 	void initialize();
+	static void prepareSession(pqxx::connection& connection);
 };
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "term_dictionary.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+TermDictionary::TermDictionary(DB_Pool& pool, size_t shards)
+    : pool_(pool) {
+    size_t count = shards > 0 ? shards : 1;
+    for (size_t i = 0; i < count; i++) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+TermDictionary::Shard& TermDictionary::shardFor(const std::string& word) const {
+    return *shards_[std::hash<std::string>{}(word) % shards_.size()];
+}
+
+bool TermDictionary::find(const std::string& word, int& id) const {
+    Shard& shard = shardFor(word);
+    std::shared_lock<std::shared_mutex> lock(shard.m);
+    auto it = shard.ids.find(word);
+    if (it == shard.ids.end()) {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+void TermDictionary::insert(const pqxx::result& rows) {
+    for (const auto& row : rows) {
+        std::string word = row["word"].as<std::string>();
+        Shard& shard = shardFor(word);
+        std::unique_lock<std::shared_mutex> lock(shard.m);
+        shard.ids[std::move(word)] = row["id"].as<int>();
+    }
+}
+
+void TermDictionary::preload() {
+    auto connection = pool_.acquire();
+    pqxx::nontransaction work(*connection);
+    insert(work.exec("SELECT id, word FROM words;"));
+}
+
+void TermDictionary::resolve(const std::vector<std::string>& words, std::vector<int>& ids) {
+    ids.assign(words.size(), 0);
+
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < words.size(); i++) {
+        if (!find(words[i], ids[i])) {
+            missing.push_back(i);
+        }
+    }
+    hits_.fetch_add(words.size() - missing.size(), std::memory_order_relaxed);
+    misses_.fetch_add(missing.size(), std::memory_order_relaxed);
+    if (missing.empty()) {
+        return;
+    }
+
+    std::vector<std::string> unseen;
+    for (size_t i : missing) {
+        unseen.push_back(words[i]);
+    }
+    std::sort(unseen.begin(), unseen.end());
+    unseen.erase(std::unique(unseen.begin(), unseen.end()), unseen.end());
+    allocate(unseen);
+
+    for (size_t i : missing) {
+        if (!find(words[i], ids[i])) {
+            throw std::runtime_error("   id : " + words[i]);
+        }
+    }
+}
+
+void TermDictionary::allocate(const std::vector<std::string>& words) {
+    auto connection = pool_.acquire();
+    pqxx::work work(*connection);
+
+    //    INSERT,   -   words
+    pqxx::result rows = work.exec_params(R"(
+        WITH input AS (
+            SELECT DISTINCT unnest($1::varchar[]) AS word
+        ), ins AS (
+            INSERT INTO words (word)
+            SELECT word FROM input
+            ORDER BY word
+            ON CONFLICT (word) DO NOTHING
+            RETURNING id, word
+        )
+        SELECT id, word FROM ins
+        UNION ALL
+        SELECT w.id, w.word FROM words w JOIN input i ON i.word = w.word;
+    )", words);
+    work.commit();
+    insert(rows);
+
+    // ,      ,    INSERT,
+    //  :     
+    if (rows.size() < words.size()) {
+        pqxx::nontransaction again(*connection);
+        insert(again.exec_params("SELECT id, word FROM words WHERE word = ANY($1);", words));
+    }
+}
+
+TermDictionary::Stats TermDictionary::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard->m);
+        stats.words += shard->ids.size();
+    }
+    return stats;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <shared_mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "DB_pool.h"
+
+//   :  -> id   words. id   , 
+//         .  
+//     ,  -    
+class TermDictionary {
+public:
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;  // ,  id     
+		size_t words = 0;
+	};
+
+	TermDictionary(DB_Pool& pool, size_t shards);
+
+	//    words
+	void preload();
+
+	// ids[i] - id  words[i]. ,    ,   words
+	//    ,   :      id
+	void resolve(const std::vector<std::string>& words, std::vector<int>& ids);
+
+	Stats stats() const;
+
+	TermDictionary(const TermDictionary&) = delete;
+	TermDictionary& operator=(const TermDictionary&) = delete;
+
+private:
+	struct Shard {
+		mutable std::shared_mutex m;
+		std::unordered_map<std::string, int> ids;
+	};
+
+	DB_Pool& pool_;
+	std::vector<std::unique_ptr<Shard>> shards_;
+	std::atomic<uint64_t> hits_{0};
+	std::atomic<uint64_t> misses_{0};
+
+	Shard& shardFor(const std::string& word) const;
+	bool find(const std::string& word, int& id) const;
+	void insert(const pqxx::result& rows);
+	void allocate(const std::vector<std::string>& words);
+};
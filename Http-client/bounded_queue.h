@@ -0,0 +1,155 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+//         .
+//    :   
+// ,      . close()   
+template <class T>
+class BoundedQueue {
+public:
+	struct Stats {
+		size_t depth = 0;
+		size_t maxDepth = 0;
+		uint64_t pushed = 0;
+		uint64_t popped = 0;
+		uint64_t blockedPushes = 0;  //     
+	};
+
+	explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+	size_t capacity() const { return capacity_; }
+
+	// false,   
+	bool push(T&& item)
+	{
+		std::unique_lock<std::mutex> lock(m_);
+		if (!waitForSpace(lock)) {
+			return false;
+		}
+		enqueue(std::move(item));
+		lock.unlock();
+		notEmpty_.notify_one();
+		return true;
+	}
+
+	//    ,    (,   ):
+	// pushReserved   . false,   
+	bool reserve()
+	{
+		std::unique_lock<std::mutex> lock(m_);
+		if (!waitForSpace(lock)) {
+			return false;
+		}
+		reserved_++;
+		return true;
+	}
+
+	void pushReserved(T&& item)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_);
+			reserved_--;
+			enqueue(std::move(item));
+		}
+		notEmpty_.notify_one();
+	}
+
+	//  ,      
+	void unreserve()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_);
+			reserved_--;
+		}
+		notFull_.notify_one();
+	}
+
+	//  ; false,     
+	bool pop(T& item)
+	{
+		std::unique_lock<std::mutex> lock(m_);
+		notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+		return dequeue(lock, item);
+	}
+
+	//  pop,     timeout; false    
+	template <class Rep, class Period>
+	bool popFor(T& item, std::chrono::duration<Rep, Period> timeout)
+	{
+		std::unique_lock<std::mutex> lock(m_);
+		notEmpty_.wait_for(lock, timeout, [this] { return closed_ || !items_.empty(); });
+		return dequeue(lock, item);
+	}
+
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_);
+			closed_ = true;
+		}
+		notEmpty_.notify_all();
+		notFull_.notify_all();
+	}
+
+	bool closed() const
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		return closed_;
+	}
+
+	Stats stats() const
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		Stats stats = stats_;
+		stats.depth = items_.size() + reserved_;
+		return stats;
+	}
+
+	BoundedQueue(const BoundedQueue&) = delete;
+	BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+private:
+	const size_t capacity_;
+	mutable std::mutex m_;
+	std::condition_variable notEmpty_;
+	std::condition_variable notFull_;
+	std::deque<T> items_;
+	size_t reserved_ = 0;
+	bool closed_ = false;
+	Stats stats_;
+
+	bool waitForSpace(std::unique_lock<std::mutex>& lock)
+	{
+		if (!closed_ && items_.size() + reserved_ >= capacity_) {
+			stats_.blockedPushes++;
+			notFull_.wait(lock, [this] { return closed_ || items_.size() + reserved_ < capacity_; });
+		}
+		return !closed_;
+	}
+
+	void enqueue(T&& item)
+	{
+		items_.push_back(std::move(item));
+		stats_.pushed++;
+		stats_.maxDepth = std::max(stats_.maxDepth, items_.size() + reserved_);
+	}
+
+	bool dequeue(std::unique_lock<std::mutex>& lock, T& item)
+	{
+		if (items_.empty()) {
+			return false;
+		}
+		item = std::move(items_.front());
+		items_.pop_front();
+		stats_.popped++;
+		lock.unlock();
+		notFull_.notify_one();
+		return true;
+	}
+};
@@ -0,0 +1,150 @@
+#include "charset.h"
+
+#include <map>
+#include <mutex>
+#include <cctype>
+
+#include <boost/locale.hpp>
+
+namespace {
+
+std::string toLowerAscii(std::string_view s)
+{
+	std::string result(s);
+	for (char& c : result) {
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+	return result;
+}
+
+//  charset=...    "text/html; charset=windows-1251"
+std::string charsetParameter(std::string_view text)
+{
+	std::string lower = toLowerAscii(text);
+	size_t pos = lower.find("charset=");
+	if (pos == std::string::npos) {
+		return "";
+	}
+	pos += 8;
+	while (pos < lower.size() && (lower[pos] == '"' || lower[pos] == '\'' || lower[pos] == ' ')) {
+		pos++;
+	}
+	size_t end = lower.find_first_of("\"'; \t\r\n/>", pos);
+	return lower.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+}
+
+//     
+bool isMultiByteCharset(const std::string& charset)
+{
+	static const char* prefixes[] = {"utf-16", "utf-32", "ucs-", "shift_jis", "sjis", "euc-", "gb", "big5", "iso-2022", "cp932", "cp936", "cp949", "cp950", "ks_c"};
+	for (const char* prefix : prefixes) {
+		if (charset.compare(0, std::char_traits<char>::length(prefix), prefix) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+std::string detectCharset(std::string_view contentType, std::string_view head)
+{
+	if (head.substr(0, 3) == "\xEF\xBB\xBF") {
+		return "utf-8";
+	}
+
+	std::string charset = charsetParameter(contentType);
+	if (!charset.empty()) {
+		return charset;
+	}
+
+	// <meta charset="...">  <meta http-equiv="Content-Type" content="...; charset=...">
+	std::string lower = toLowerAscii(head.substr(0, charsetSniffLength));
+	size_t pos = 0;
+	while ((pos = lower.find("<meta", pos)) != std::string::npos) {
+		size_t end = lower.find('>', pos);
+		charset = charsetParameter(std::string_view(lower).substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+		if (!charset.empty()) {
+			return charset;
+		}
+		pos += 5;
+	}
+
+	return "";
+}
+
+bool isUtf8Charset(const std::string& charset)
+{
+	//    ASCII   UTF-8
+	return charset.empty() || charset == "utf-8" || charset == "utf8" || charset == "us-ascii" || charset == "ascii";
+}
+
+Utf8Converter::Utf8Converter(const std::string& charset)
+	: charset_(toLowerAscii(charset)), identity_(isUtf8Charset(charset_))
+{
+	if (!identity_ && !isMultiByteCharset(charset_)) {
+		table_ = singleByteTable(charset_);
+	}
+}
+
+std::shared_ptr<const Utf8Converter::Table> Utf8Converter::singleByteTable(const std::string& charset)
+{
+	static std::mutex mutex;
+	static std::map<std::string, std::shared_ptr<const Table>> tables;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = tables.find(charset);
+	if (it != tables.end()) {
+		return it->second;
+	}
+
+	std::shared_ptr<Table> table;
+	try {
+		table = std::make_shared<Table>();
+		for (int c = 0; c < 256; c++) {
+			std::string byte(1, static_cast<char>(c));
+			(*table)[c] = boost::locale::conv::to_utf<char>(byte, charset, boost::locale::conv::skip);
+		}
+	}
+	catch (const std::exception&) {
+		table.reset(); //  :    
+	}
+
+	tables[charset] = table;
+	return table;
+}
+
+void Utf8Converter::feed(std::string_view chunk, std::string& out)
+{
+	if (identity_) {
+		out.append(chunk.data(), chunk.size());
+	}
+	else if (table_) {
+		const Table& table = *table_;
+		for (unsigned char c : chunk) {
+			if (c < 0x80) {
+				out += static_cast<char>(c);
+			}
+			else {
+				out += table[c];
+			}
+		}
+	}
+	else {
+		pending_.append(chunk.data(), chunk.size());
+	}
+}
+
+void Utf8Converter::finish(std::string& out)
+{
+	if (pending_.empty()) {
+		return;
+	}
+	try {
+		out += boost::locale::conv::to_utf<char>(pending_, charset_, boost::locale::conv::skip);
+	}
+	catch (const std::exception&) {
+		out += pending_;
+	}
+	pending_.clear();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+
+//   ,    <meta charset>
+constexpr size_t charsetSniffLength = 4096;
+
+//  : BOM,  charset  Content-Type,  <meta>  
+// charsetSniffLength .   -   
+std::string detectCharset(std::string_view contentType, std::string_view head);
+
+bool isUtf8Charset(const std::string& charset);
+
+//     UTF-8.  UTF-8    ,
+//       256 , 
+//    ;       finish()
+class Utf8Converter {
+public:
+	explicit Utf8Converter(const std::string& charset);
+
+	void feed(std::string_view chunk, std::string& out);
+	void finish(std::string& out);
+
+	bool identity() const { return identity_; }
+
+private:
+	using Table = std::array<std::string, 256>;
+
+	std::string charset_;
+	bool identity_;
+	std::shared_ptr<const Table> table_;
+	std::string pending_;
+
+	static std::shared_ptr<const Table> singleByteTable(const std::string& charset);
+};
@@ -0,0 +1,82 @@
+#include "connection_pool.h"
+
+ConnectionPool::ConnectionPool(size_t maxIdlePerHost, std::chrono::seconds idleTimeout)
+	: maxIdlePerHost_(maxIdlePerHost), idleTimeout_(idleTimeout)
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+	for (auto& [host, session] : sessions_) {
+		SSL_SESSION_free(session);
+	}
+}
+
+void ConnectionPool::prepareSession(const std::string& host, SSL* ssl)
+{
+	std::lock_guard<std::mutex> lock(m_);
+	auto it = sessions_.find(host);
+	if (it != sessions_.end()) {
+		SSL_set_session(ssl, it->second);
+	}
+}
+
+void ConnectionPool::saveSession(const std::string& host, SSL* ssl)
+{
+	if (SSL_session_reused(ssl)) {
+		resumed_++;
+	}
+	else {
+		handshakes_++;
+	}
+
+	//  TLS 1.3     ,     
+	SSL_SESSION* session = SSL_get1_session(ssl);
+	if (session == nullptr) {
+		return;
+	}
+	if (!SSL_SESSION_is_resumable(session)) {
+		SSL_SESSION_free(session);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_);
+	auto& stored = sessions_[host];
+	if (stored != nullptr) {
+		SSL_SESSION_free(stored);
+	}
+	stored = session;
+}
+
+template <class Stream>
+void ConnectionPool::evict(IdleMap<Stream>& map, std::chrono::steady_clock::time_point now)
+{
+	for (auto it = map.begin(); it != map.end();) {
+		auto& queue = it->second;
+		//         
+		while (!queue.empty() && now - queue.front().since >= idleTimeout_) {
+			queue.pop_front();
+			evicted_++;
+		}
+		it = queue.empty() ? map.erase(it) : std::next(it);
+	}
+}
+
+void ConnectionPool::evictIdle()
+{
+	std::lock_guard<std::mutex> lock(m_);
+	auto now = std::chrono::steady_clock::now();
+	evict(tcpIdle_, now);
+	evict(sslIdle_, now);
+}
+
+ConnectionPool::Stats ConnectionPool::stats() const
+{
+	Stats s;
+	s.hits = hits_;
+	s.misses = misses_;
+	s.handshakes = handshakes_;
+	s.resumed = resumed_;
+	s.evicted = evicted_;
+	return s;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <openssl/ssl.h>
+
+//   keep-alive    (, )
+//   TLS-      
+class ConnectionPool {
+public:
+	using TcpStream = boost::beast::tcp_stream;
+	using SslStream = boost::beast::ssl_stream<boost::beast::tcp_stream>;
+
+	struct Stats {
+		size_t hits = 0;           // ,    
+		size_t misses = 0;         // ,     
+		size_t handshakes = 0;     //  TLS-
+		size_t resumed = 0;        //    
+		size_t evicted = 0;        // ,     
+	};
+
+	ConnectionPool(size_t maxIdlePerHost, std::chrono::seconds idleTimeout);
+	~ConnectionPool();
+
+	template <class Stream>
+	std::unique_ptr<Stream> acquire(const std::string& host);
+
+	template <class Stream>
+	void release(const std::string& host, std::unique_ptr<Stream> stream);
+
+	//     
+	void prepareSession(const std::string& host, SSL* ssl);
+	//          
+	void saveSession(const std::string& host, SSL* ssl);
+
+	void evictIdle();
+	Stats stats() const;
+
+	ConnectionPool(const ConnectionPool&) = delete;
+	ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+private:
+	template <class Stream>
+	struct Idle {
+		std::unique_ptr<Stream> stream;
+		std::chrono::steady_clock::time_point since;
+	};
+
+	template <class Stream>
+	using IdleMap = std::unordered_map<std::string, std::deque<Idle<Stream>>>;
+
+	const size_t maxIdlePerHost_;
+	const std::chrono::seconds idleTimeout_;
+
+	mutable std::mutex m_;
+	IdleMap<TcpStream> tcpIdle_;
+	IdleMap<SslStream> sslIdle_;
+	std::unordered_map<std::string, SSL_SESSION*> sessions_;
+
+	std::atomic<size_t> hits_{0};
+	std::atomic<size_t> misses_{0};
+	std::atomic<size_t> handshakes_{0};
+	std::atomic<size_t> resumed_{0};
+	std::atomic<size_t> evicted_{0};
+
+	IdleMap<TcpStream>& idle(TcpStream*) { return tcpIdle_; }
+	IdleMap<SslStream>& idle(SslStream*) { return sslIdle_; }
+
+	template <class Stream>
+	void evict(IdleMap<Stream>& map, std::chrono::steady_clock::time_point now);
+};
+
+template <class Stream>
+std::unique_ptr<Stream> ConnectionPool::acquire(const std::string& host)
+{
+	std::lock_guard<std::mutex> lock(m_);
+	auto& map = idle(static_cast<Stream*>(nullptr));
+	auto it = map.find(host);
+	auto now = std::chrono::steady_clock::now();
+
+	while (it != map.end() && !it->second.empty()) {
+		//    :       
+		Idle<Stream> entry = std::move(it->second.back());
+		it->second.pop_back();
+
+		if (now - entry.since < idleTimeout_ && boost::beast::get_lowest_layer(*entry.stream).socket().is_open()) {
+			hits_++;
+			return std::move(entry.stream);
+		}
+		evicted_++;
+	}
+
+	misses_++;
+	return nullptr;
+}
+
+template <class Stream>
+void ConnectionPool::release(const std::string& host, std::unique_ptr<Stream> stream)
+{
+	std::lock_guard<std::mutex> lock(m_);
+	auto& queue = idle(static_cast<Stream*>(nullptr))[host];
+	if (queue.size() >= maxIdlePerHost_) {
+		queue.pop_front(); //    
+		evicted_++;
+	}
+	queue.push_back({std::move(stream), std::chrono::steady_clock::now()});
+}
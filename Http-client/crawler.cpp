@@ -0,0 +1,428 @@
+#include "crawler.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstring>
+#include <optional>
+
+#include "http_utils.h"
+#include "parser.h"
+
+namespace {
+
+//         (MurmurHash64A).    ,
+//       std::hash
+uint64_t contentHash(const std::string& data)
+{
+	const uint64_t m = 0xc6a4a7935bd1e995ULL;
+	const int r = 47;
+
+	uint64_t h = 0x9747b28c ^ (data.size() * m);
+	size_t blocks = data.size() / 8;
+	for (size_t i = 0; i < blocks; i++) {
+		uint64_t k;
+		std::memcpy(&k, data.data() + i * 8, sizeof(k));
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+		h ^= k;
+		h *= m;
+	}
+
+	const auto* tail = reinterpret_cast<const unsigned char*>(data.data()) + blocks * 8;
+	switch (data.size() & 7) {
+	case 7: h ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+	case 6: h ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+	case 5: h ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+	case 4: h ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+	case 3: h ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+	case 2: h ^= uint64_t(tail[1]) << 8; [[fallthrough]];
+	case 1:
+		h ^= uint64_t(tail[0]);
+		h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+	return h;
+}
+
+}
+
+void Crawler::Counter::record(std::chrono::steady_clock::time_point started)
+{
+	processed.fetch_add(1, std::memory_order_relaxed);
+	busyMicros.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - started).count(), std::memory_order_relaxed);
+}
+
+Crawler::Crawler(const Config::Spider& settings, Fetcher& fetcher, Frontier& frontier, IndexBatcher& index, bool positions,
+	std::unordered_map<std::string, PageState> known)
+	: fetcher_(fetcher), frontier_(frontier), index_(index), positions_(positions),
+	parseWorkers_(settings.workers > 0 ? settings.workers : std::max(1u, std::thread::hardware_concurrency())),
+	linkWorkers_(std::max<size_t>(settings.linkWorkers, 1)),
+	maxInFlight_(settings.maxInFlight),
+	statsInterval_(settings.statsInterval),
+	known_(std::move(known)),
+	dedupe_(settings.duplicateDistance >= 0),
+	duplicates_(static_cast<unsigned>(std::max(settings.duplicateDistance, 0))),
+	scheduler_(settings),
+	parsing_(settings.queueCapacity),
+	linking_(settings.queueCapacity)
+{
+	//    :   ,     
+	if (dedupe_) {
+		for (const auto& [url, state] : known_) {
+			if (state.fingerprint != 0 && state.canonicalUrl.empty()) {
+				duplicates_.add(url, state.fingerprint);
+			}
+		}
+	}
+}
+
+Crawler::~Crawler()
+{
+	stop();
+}
+
+void Crawler::run(const Link& link, int depth)
+{
+	Link canonical = link;
+	if (!frontier_.tryVisit(canonical, depth)) {
+		return;
+	}
+
+	started_ = std::chrono::steady_clock::now();
+	active_ = 1;
+	scheduler_.push({canonical, depth});
+
+	//      ,   
+	//         .    
+	//     ,    
+	for (const auto& [url, state] : known_) {
+		Link link;
+		try {
+			link = Link::parse(url);
+		}
+		catch (const std::exception&) {
+			continue;
+		}
+		if (frontier_.tryVisit(link, state.depth)) {
+			active_++;
+			scheduler_.push({std::move(link), state.depth});
+		}
+	}
+
+	threads_.emplace_back(&Crawler::dispatch, this);
+	for (size_t i = 0; i < parseWorkers_; i++) {
+		threads_.emplace_back(&Crawler::parseWorker, this);
+	}
+	for (size_t i = 0; i < linkWorkers_; i++) {
+		threads_.emplace_back(&Crawler::linkWorker, this);
+	}
+
+	std::unique_lock<std::mutex> lock(doneMutex_);
+	auto done = [this] { return active_.load() == 0; };
+	if (statsInterval_.count() > 0) {
+		while (!doneCondition_.wait_for(lock, statsInterval_, done)) {
+			lock.unlock();
+			report();
+			lock.lock();
+		}
+	}
+	else {
+		doneCondition_.wait(lock, done);
+	}
+	lock.unlock();
+
+	stop();
+}
+
+void Crawler::stop()
+{
+	scheduler_.close();
+	parsing_.close();
+	linking_.close();
+	for (auto& thread : threads_) {
+		thread.join();
+	}
+	threads_.clear();
+}
+
+void Crawler::finishUnit()
+{
+	if (active_.fetch_sub(1) == 1) {
+		std::lock_guard<std::mutex> lock(doneMutex_);
+		doneCondition_.notify_all();
+	}
+}
+
+//  :       ,
+//  ,         .
+//   ,       
+void Crawler::dispatch()
+{
+	Pending pending;
+	while (parsing_.reserve()) {
+		if (!scheduler_.pop(pending)) {
+			break;
+		}
+		Fetcher::Validators validators;
+		if (const PageState* previous = previousState(getLinkText(pending.link), pending.depth)) {
+			validators = {previous->etag, previous->lastModified};
+		}
+
+		auto started = std::chrono::steady_clock::now();
+		fetcher_.fetch(pending.link, [this, pending, started](FetchResult&& result) mutable {
+			unsigned status = result.ec ? 0 : result.header.result_int();
+			auto retryAfter = result.header[boost::beast::http::field::retry_after];
+			if (scheduler_.complete(pending, status, std::string_view(retryAfter.data(), retryAfter.size()))) {
+				parsing_.unreserve(); //   :    
+				return;
+			}
+			fetched_.record(started);
+			parsing_.pushReserved({std::move(result), pending.depth});
+			}, std::move(validators));
+	}
+}
+
+void Crawler::parseWorker()
+{
+	Fetched fetched;
+	while (parsing_.pop(fetched)) {
+		auto started = std::chrono::steady_clock::now();
+		parse(fetched);
+		parsed_.record(started);
+		finishUnit();
+	}
+}
+
+void Crawler::parse(Fetched& fetched)
+{
+	std::vector<Pending> links;
+	try {
+		const Link& link = fetched.result.link;
+		const auto& header = fetched.result.header;
+		bool ok = !fetched.result.ec;
+
+		PageState state;
+		state.depth = fetched.depth;
+		if (ok) {
+			state.etag = std::string(header[boost::beast::http::field::etag]);
+			state.lastModified = std::string(header[boost::beast::http::field::last_modified]);
+			if (header.result() == boost::beast::http::status::ok && !fetched.result.binary) {
+				state.contentHash = contentHash(fetched.result.body);
+			}
+		}
+
+		//     ,       
+		std::string url = getLinkText(link);
+		const PageState* previous = previousState(url, fetched.depth);
+		bool notModified = ok && header.result() == boost::beast::http::status::not_modified;
+		bool sameBody = ok && header.result() == boost::beast::http::status::ok && !fetched.result.binary
+			&& previous && state.contentHash == previous->contentHash;
+		if (previous && (notModified || sameBody)) {
+			state.fingerprint = previous->fingerprint;
+			state.canonicalUrl = previous->canonicalUrl;
+			if (notModified) {
+				// 304    ,   
+				state.contentHash = previous->contentHash;
+				if (state.etag.empty()) {
+					state.etag = previous->etag;
+				}
+				if (state.lastModified.empty()) {
+					state.lastModified = previous->lastModified;
+				}
+				notModified_.fetch_add(1, std::memory_order_relaxed);
+			}
+			else {
+				unchanged_.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			PageWords page;
+			page.url = std::move(url);
+			page.state = std::move(state);
+			page.unchanged = true;
+			index_.add(std::move(page));
+			return;
+		}
+
+		//  :       ,  
+		//       .     404  410
+		unsigned status = ok ? header.result_int() : 0;
+		bool transient = !ok || status == 408 || status == 429 || status >= 500;
+		auto known = known_.find(url); //    ,    previousState
+		if (transient && known != known_.end()) {
+			PageWords page;
+			page.url = std::move(url);
+			page.state = known->second;
+			page.unchanged = true;
+			index_.add(std::move(page));
+			return;
+		}
+
+		std::string html = getHtmlContent(fetched.result, [&](const Link& newLink) {
+			links.push_back({newLink, fetched.depth}); //  -    
+			});
+
+		if (html.size() == 0) {
+			std::cout << "Failed to get HTML Content for: " << link.hostName << link.query << std::endl;
+		}
+		else {
+			PageWords page;
+			page.url = std::move(url);
+			page.state = std::move(state);
+			std::vector<Link> pageLinks;
+			parsePage(html, link, page.wordsCount, fetched.depth > 0 ? &pageLinks : nullptr,
+				positions_ ? &page.positions : nullptr);
+
+			//  :      ,    
+			page.state.fingerprint = DuplicateIndex::fingerprint(page);
+			std::optional<DuplicateIndex::Match> duplicate;
+			if (dedupe_ && page.state.fingerprint != 0) {
+				duplicate = duplicates_.findOrAdd(page.url, page.state.fingerprint);
+			}
+			if (duplicate) {
+				page.state.canonicalUrl = std::move(duplicate->canonical);
+				page.wordsCount.clear();
+				page.positions.clear();
+			}
+			else {
+				indexed_.fetch_add(1, std::memory_order_relaxed);
+			}
+			index_.add(std::move(page)); // ,      
+
+			for (auto& pageLink : pageLinks) {
+				links.push_back({std::move(pageLink), fetched.depth - 1});
+			}
+		}
+	}
+	catch (const std::exception& e) {
+		std::cout << e.what() << std::endl;
+	}
+
+	if (!links.empty()) {
+		active_++;
+		if (!linking_.push(std::move(links))) {
+			active_--;
+		}
+	}
+}
+
+//     ,      ,  :
+//     ,     
+const PageState* Crawler::previousState(const std::string& url, int depth) const
+{
+	auto it = known_.find(url);
+	if (it == known_.end() || depth > it->second.depth) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
+Crawler::RecrawlStats Crawler::recrawlStats() const
+{
+	RecrawlStats stats;
+	stats.known = known_.size();
+	stats.notModified = notModified_.load(std::memory_order_relaxed);
+	stats.unchanged = unchanged_.load(std::memory_order_relaxed);
+	stats.indexed = indexed_.load(std::memory_order_relaxed);
+	return stats;
+}
+
+//   :      
+void Crawler::linkWorker()
+{
+	std::vector<Pending> links;
+	while (linking_.pop(links)) {
+		auto started = std::chrono::steady_clock::now();
+		for (auto& pending : links) {
+			if (!frontier_.tryVisit(pending.link, pending.depth)) {
+				continue; //             
+			}
+			active_++;
+			if (!scheduler_.push(std::move(pending))) {
+				active_--;
+			}
+		}
+		linked_.record(started);
+		finishUnit();
+	}
+}
+
+std::vector<Crawler::StageStats> Crawler::stats() const
+{
+	std::vector<StageStats> stages;
+
+	auto fromQueue = [](StageStats& stage, const auto& queue, size_t capacity) {
+		auto queueStats = queue.stats();
+		stage.depth = queueStats.depth;
+		stage.maxDepth = queueStats.maxDepth;
+		stage.capacity = capacity;
+	};
+	auto fromCounter = [](StageStats& stage, const Counter& counter) {
+		stage.processed = counter.processed.load(std::memory_order_relaxed);
+		stage.busySeconds = counter.busyMicros.load(std::memory_order_relaxed) / 1e6;
+	};
+
+	auto hostStats = scheduler_.stats();
+	StageStats fetch;
+	fetch.name = "fetch";
+	fetch.workers = maxInFlight_;
+	fetch.depth = hostStats.queued;
+	fetch.maxDepth = hostStats.maxQueued;
+	fromCounter(fetch, fetched_);
+	stages.push_back(fetch);
+
+	StageStats parse;
+	parse.name = "parse";
+	parse.workers = parseWorkers_;
+	fromQueue(parse, parsing_, parsing_.capacity());
+	fromCounter(parse, parsed_);
+	stages.push_back(parse);
+
+	auto indexStats = index_.stats();
+	StageStats index;
+	index.name = "index";
+	index.workers = indexStats.workers;
+	index.depth = indexStats.queue.depth;
+	index.maxDepth = indexStats.queue.maxDepth;
+	index.capacity = indexStats.capacity;
+	index.processed = indexStats.pages;
+	index.busySeconds = indexStats.busySeconds;
+	stages.push_back(index);
+
+	StageStats links;
+	links.name = "links";
+	links.workers = linkWorkers_;
+	fromQueue(links, linking_, linking_.capacity());
+	fromCounter(links, linked_);
+	stages.push_back(links);
+
+	return stages;
+}
+
+//   -          100%
+void Crawler::report() const
+{
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+	if (elapsed <= 0) {
+		return;
+	}
+
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1);
+	for (const auto& stage : stats()) {
+		out << "  " << std::left << std::setw(6) << stage.name << std::right
+			<< " workers " << stage.workers << ", queue " << stage.depth;
+		if (stage.capacity > 0) {
+			out << "/" << stage.capacity;
+		}
+		out << " (max " << stage.maxDepth << "), done " << stage.processed
+			<< " (" << stage.processed / elapsed << "/s), busy "
+			<< 100.0 * stage.busySeconds / (elapsed * std::max<size_t>(stage.workers, 1)) << "%\n";
+	}
+	std::cout << "stages after " << elapsed << " s:\n" << out.str() << std::flush;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <unordered_map>
+
+#include "bounded_queue.h"
+#include "fetcher.h"
+#include "host_scheduler.h"
+#include "duplicate_index.h"
+#include "frontier.h"
+#include "index_batcher.h"
+#include "../Config/config.h"
+
+//  -  ,  :
+//    ->  (, , ) ->   
+//                 \->     -> 
+//      .    ,    :
+//    .  ,    
+//      .      
+//    (        ):   ,
+//    .     HostScheduler     .
+//       :    ,
+//   (304     )      .
+//       ,    
+class Crawler {
+public:
+	struct StageStats {
+		std::string name;
+		size_t workers = 0;     //   -   
+		size_t depth = 0;       //    
+		size_t capacity = 0;    // 0 -   
+		size_t maxDepth = 0;
+		uint64_t processed = 0;
+		double busySeconds = 0;  //      
+	};
+
+	struct RecrawlStats {
+		size_t known = 0;          // ,    
+		uint64_t notModified = 0;  //  304   
+		uint64_t unchanged = 0;    //  ,     
+		uint64_t indexed = 0;      //    ,     
+	};
+
+	// known -     ( -  )
+	Crawler(const Config::Spider& settings, Fetcher& fetcher, Frontier& frontier, IndexBatcher& index, bool positions,
+		std::unordered_map<std::string, PageState> known = {});
+	~Crawler();
+
+	//   link   ;   statsInterval   
+	void run(const Link& link, int depth);
+
+	std::vector<StageStats> stats() const;
+	void report() const;
+	const HostScheduler& scheduler() const { return scheduler_; }
+	RecrawlStats recrawlStats() const;
+	DuplicateIndex::Stats duplicateStats() const { return duplicates_.stats(); }
+
+	Crawler(const Crawler&) = delete;
+	Crawler& operator=(const Crawler&) = delete;
+
+private:
+	using Pending = HostScheduler::Task;
+	struct Fetched {
+		FetchResult result;
+		int depth = 0;
+	};
+
+	struct Counter {
+		std::atomic<uint64_t> processed{0};
+		std::atomic<uint64_t> busyMicros{0};
+
+		void record(std::chrono::steady_clock::time_point started);
+	};
+
+	Fetcher& fetcher_;
+	Frontier& frontier_;
+	IndexBatcher& index_;
+	const bool positions_;   //     
+	const size_t parseWorkers_;
+	const size_t linkWorkers_;
+	const size_t maxInFlight_;
+	const std::chrono::seconds statsInterval_;
+	const std::unordered_map<std::string, PageState> known_;
+	const bool dedupe_;
+	DuplicateIndex duplicates_;
+
+	HostScheduler scheduler_;
+	BoundedQueue<Fetched> parsing_;
+	BoundedQueue<std::vector<Pending>> linking_;
+	std::vector<std::thread> threads_;
+
+	Counter fetched_;
+	Counter parsed_;
+	Counter linked_;
+	std::atomic<uint64_t> notModified_{0};
+	std::atomic<uint64_t> unchanged_{0};
+	std::atomic<uint64_t> indexed_{0};
+	std::chrono::steady_clock::time_point started_;
+
+	//  :           
+	//   .  ,   
+	std::atomic<size_t> active_{0};
+	std::mutex doneMutex_;
+	std::condition_variable doneCondition_;
+
+	void dispatch();
+	void parseWorker();
+	void linkWorker();
+	void parse(Fetched& fetched);
+	const PageState* previousState(const std::string& url, int depth) const;
+	void finishUnit();
+	void stop();
+};
@@ -0,0 +1,197 @@
+#include "decompressor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <zlib.h>
+
+#ifdef SPIDER_HAVE_BROTLI
+#include <brotli/decode.h>
+#endif
+
+namespace {
+
+constexpr size_t outputStep = 64 * 1024;
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b)
+{
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.size(); i++) {
+		if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+struct Decompressor::Impl {
+	z_stream zs{};
+	bool zlibReady = false;
+	bool rawDeflateTried = false;
+	bool finished = false;
+#ifdef SPIDER_HAVE_BROTLI
+	BrotliDecoderState* brotli = nullptr;
+#endif
+
+	~Impl() {
+		if (zlibReady) {
+			inflateEnd(&zs);
+		}
+#ifdef SPIDER_HAVE_BROTLI
+		if (brotli) {
+			BrotliDecoderDestroyInstance(brotli);
+		}
+#endif
+	}
+};
+
+Decompressor::Encoding Decompressor::parse(std::string_view contentEncoding)
+{
+	//      
+	while (!contentEncoding.empty() && contentEncoding.front() == ' ') {
+		contentEncoding.remove_prefix(1);
+	}
+	while (!contentEncoding.empty() && contentEncoding.back() == ' ') {
+		contentEncoding.remove_suffix(1);
+	}
+
+	if (contentEncoding.empty() || equalsIgnoreCase(contentEncoding, "identity")) {
+		return Encoding::Identity;
+	}
+	if (equalsIgnoreCase(contentEncoding, "gzip") || equalsIgnoreCase(contentEncoding, "x-gzip")) {
+		return Encoding::Gzip;
+	}
+	if (equalsIgnoreCase(contentEncoding, "deflate")) {
+		return Encoding::Deflate;
+	}
+#ifdef SPIDER_HAVE_BROTLI
+	if (equalsIgnoreCase(contentEncoding, "br")) {
+		return Encoding::Brotli;
+	}
+#endif
+	return Encoding::Unsupported;
+}
+
+const char* Decompressor::acceptEncoding()
+{
+#ifdef SPIDER_HAVE_BROTLI
+	return "gzip, deflate, br";
+#else
+	return "gzip, deflate";
+#endif
+}
+
+Decompressor::Decompressor(Encoding encoding)
+	: encoding_(encoding), impl_(std::make_unique<Impl>())
+{
+	if (encoding_ == Encoding::Gzip || encoding_ == Encoding::Deflate) {
+		// 15 + 32:   gzip/zlib
+		impl_->zlibReady = inflateInit2(&impl_->zs, 15 + 32) == Z_OK;
+	}
+#ifdef SPIDER_HAVE_BROTLI
+	else if (encoding_ == Encoding::Brotli) {
+		impl_->brotli = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+	}
+#endif
+}
+
+Decompressor::~Decompressor() = default;
+
+Decompressor::Status Decompressor::write(std::string_view input, std::string& out, size_t limit)
+{
+	if (encoding_ == Encoding::Identity) {
+		size_t take = std::min(input.size(), limit > out.size() ? limit - out.size() : 0);
+		out.append(input.data(), take);
+		return take < input.size() ? Status::LimitReached : Status::Ok;
+	}
+
+	if (impl_->finished) {
+		return Status::Ok; //     
+	}
+
+	if (encoding_ == Encoding::Gzip || encoding_ == Encoding::Deflate) {
+		if (!impl_->zlibReady) {
+			return Status::Error;
+		}
+		z_stream& zs = impl_->zs;
+		zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+		zs.avail_in = static_cast<uInt>(input.size());
+
+		while (true) {
+			if (out.size() >= limit) {
+				return zs.avail_in > 0 ? Status::LimitReached : Status::Ok;
+			}
+			size_t offset = out.size();
+			size_t room = std::min(outputStep, limit - offset);
+			out.resize(offset + room);
+			zs.next_out = reinterpret_cast<Bytef*>(&out[offset]);
+			zs.avail_out = static_cast<uInt>(room);
+
+			int rc = inflate(&zs, Z_NO_FLUSH);
+			out.resize(offset + room - zs.avail_out);
+
+			if (rc == Z_DATA_ERROR && encoding_ == Encoding::Deflate && !impl_->rawDeflateTried && offset == 0) {
+				//    deflate   zlib
+				impl_->rawDeflateTried = true;
+				inflateEnd(&zs);
+				zs = z_stream{};
+				impl_->zlibReady = inflateInit2(&zs, -15) == Z_OK;
+				if (!impl_->zlibReady) {
+					return Status::Error;
+				}
+				zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+				zs.avail_in = static_cast<uInt>(input.size());
+				continue;
+			}
+			if (rc == Z_STREAM_END) {
+				impl_->finished = true;
+				return Status::Ok;
+			}
+			if (rc == Z_BUF_ERROR || (rc == Z_OK && zs.avail_in == 0 && zs.avail_out != 0)) {
+				return Status::Ok; //  ,   
+			}
+			if (rc != Z_OK) {
+				return Status::Error;
+			}
+		}
+	}
+
+#ifdef SPIDER_HAVE_BROTLI
+	if (encoding_ == Encoding::Brotli && impl_->brotli) {
+		size_t availableIn = input.size();
+		const uint8_t* nextIn = reinterpret_cast<const uint8_t*>(input.data());
+
+		while (true) {
+			if (out.size() >= limit) {
+				return availableIn > 0 || BrotliDecoderHasMoreOutput(impl_->brotli)
+					? Status::LimitReached : Status::Ok;
+			}
+			size_t offset = out.size();
+			size_t room = std::min(outputStep, limit - offset);
+			out.resize(offset + room);
+			size_t availableOut = room;
+			uint8_t* nextOut = reinterpret_cast<uint8_t*>(&out[offset]);
+
+			BrotliDecoderResult rc = BrotliDecoderDecompressStream(impl_->brotli,
+				&availableIn, &nextIn, &availableOut, &nextOut, nullptr);
+			out.resize(offset + room - availableOut);
+
+			if (rc == BROTLI_DECODER_RESULT_SUCCESS) {
+				impl_->finished = true;
+				return Status::Ok;
+			}
+			if (rc == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) {
+				return Status::Ok;
+			}
+			if (rc == BROTLI_DECODER_RESULT_ERROR) {
+				return Status::Error;
+			}
+		}
+	}
+#endif
+
+	return Status::Error;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <memory>
+
+//     (Content-Encoding): gzip  deflate  zlib,
+// br -     brotli (SPIDER_HAVE_BROTLI)
+class Decompressor {
+public:
+	enum class Encoding { Identity, Gzip, Deflate, Brotli, Unsupported };
+
+	enum class Status {
+		Ok,            //   
+		LimitReached,  //    
+		Error          //  
+	};
+
+	static Encoding parse(std::string_view contentEncoding);
+
+	//   Accept-Encoding    
+	static const char* acceptEncoding();
+
+	explicit Decompressor(Encoding encoding);
+	~Decompressor();
+
+	//  input,   out,  out.size()   limit
+	Status write(std::string_view input, std::string& out, size_t limit);
+
+	Decompressor(const Decompressor&) = delete;
+	Decompressor& operator=(const Decompressor&) = delete;
+
+private:
+	struct Impl;
+
+	Encoding encoding_;
+	std::unique_ptr<Impl> impl_;
+};
@@ -0,0 +1,199 @@
+#include "dns_cache.h"
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/error.hpp>
+
+namespace net = boost::asio;
+
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+std::string trim(const std::string& text)
+{
+	size_t begin = text.find_first_not_of(" \t");
+	if (begin == std::string::npos) {
+		return {};
+	}
+	size_t end = text.find_last_not_of(" \t");
+	return text.substr(begin, end - begin + 1);
+}
+
+}
+
+DnsCache::DnsCache(net::io_context& ioc, std::chrono::seconds ttl, std::chrono::seconds negativeTtl,
+	std::chrono::seconds timeout, const std::string& stub)
+	: ioc_(ioc), ttl_(ttl), negativeTtl_(negativeTtl), timeout_(timeout), stubMode_(!trim(stub).empty())
+{
+	std::istringstream records(stub);
+	std::string record;
+	while (std::getline(records, record, ';')) {
+		if (trim(record).empty()) {
+			continue;
+		}
+		size_t eq = record.find('=');
+		if (eq == std::string::npos) {
+			throw std::runtime_error("Invalid dnsStub record: " + record);
+		}
+
+		Addresses& addresses = stub_[trim(record.substr(0, eq))];
+		std::istringstream list(record.substr(eq + 1));
+		std::string address;
+		while (std::getline(list, address, ',')) {
+			boost::system::error_code ec;
+			addresses.push_back(net::ip::make_address(trim(address), ec));
+			if (ec) {
+				throw std::runtime_error("Invalid dnsStub address: " + address);
+			}
+		}
+	}
+}
+
+void DnsCache::resolve(const std::string& host, unsigned short port, net::any_io_executor executor, Handler handler)
+{
+	boost::system::error_code ec;
+	Addresses addresses;
+	uint64_t id = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		Entry& entry = entries_[host];
+		if (entry.pending) {
+			entry.waiters.push_back({port, std::move(executor), std::move(handler)});
+			coalesced_++;
+			return;
+		}
+		if (entry.expires <= std::chrono::steady_clock::now()) {
+			entry.pending = true;
+			entry.lookup = id = ++nextLookup_;
+			entry.waiters.push_back({port, std::move(executor), std::move(handler)});
+			misses_++;
+		}
+		else {
+			ec = entry.ec;
+			addresses = entry.addresses;
+			hits_++;
+		}
+	}
+
+	if (id) {
+		lookup(host, id); //      
+		return;
+	}
+	net::post(executor, [handler = std::move(handler), ec, result = endpoints(addresses, port)]() mutable {
+		handler(ec, std::move(result));
+		});
+}
+
+void DnsCache::lookup(const std::string& host, uint64_t id)
+{
+	if (stubMode_) {
+		net::post(ioc_, [this, host, id] {
+			boost::system::error_code ec;
+			auto address = net::ip::make_address(host, ec);
+			if (!ec) {
+				complete(host, id, {}, {address}); //       
+				return;
+			}
+			auto it = stub_.find(host);
+			if (it == stub_.end()) {
+				complete(host, id, net::error::host_not_found, {});
+			}
+			else {
+				complete(host, id, {}, it->second);
+			}
+			});
+		return;
+	}
+
+	//      :     ,
+	//     
+	auto resolver = std::make_shared<tcp::resolver>(ioc_);
+	auto timer = std::make_shared<net::steady_timer>(ioc_, timeout_);
+	timer->async_wait([this, resolver, host, id](boost::system::error_code ec) {
+		if (ec != net::error::operation_aborted && complete(host, id, net::error::timed_out, {})) {
+			resolver->cancel();
+		}
+		});
+
+	//     ,      http,  https
+	resolver->async_resolve(host, "0", tcp::resolver::numeric_service,
+		[this, resolver, timer, host, id](boost::system::error_code ec, tcp::resolver::results_type results) {
+			Addresses addresses;
+			for (const auto& result : results) {
+				addresses.push_back(result.endpoint().address());
+			}
+			if (!ec && addresses.empty()) {
+				ec = net::error::host_not_found;
+			}
+			if (complete(host, id, ec, std::move(addresses))) {
+				timer->cancel();
+			}
+		});
+}
+
+bool DnsCache::complete(const std::string& host, uint64_t id, boost::system::error_code ec, Addresses addresses)
+{
+	std::vector<Waiter> waiters;
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		auto it = entries_.find(host);
+		if (it == entries_.end() || !it->second.pending || it->second.lookup != id) {
+			return false;
+		}
+		Entry& entry = it->second;
+		entry.pending = false;
+		entry.ec = ec;
+		entry.addresses = std::move(addresses);
+		entry.expires = std::chrono::steady_clock::now() + (ec ? negativeTtl_ : ttl_);
+		waiters.swap(entry.waiters);
+		addresses = entry.addresses;
+	}
+	if (ec) {
+		failures_++;
+	}
+
+	//     executor  :    
+	//        strand 
+	for (auto& waiter : waiters) {
+		net::post(waiter.executor, [handler = std::move(waiter.handler), ec, result = endpoints(addresses, waiter.port)]() mutable {
+			handler(ec, std::move(result));
+			});
+	}
+	return true;
+}
+
+void DnsCache::forget(const std::string& host)
+{
+	std::lock_guard<std::mutex> lock(m_);
+	auto it = entries_.find(host);
+	if (it != entries_.end() && !it->second.pending) {
+		entries_.erase(it);
+	}
+}
+
+DnsCache::Endpoints DnsCache::endpoints(const Addresses& addresses, unsigned short port)
+{
+	Endpoints result;
+	result.reserve(addresses.size());
+	for (const auto& address : addresses) {
+		result.emplace_back(address, port);
+	}
+	return result;
+}
+
+DnsCache::Stats DnsCache::stats() const
+{
+	Stats stats;
+	stats.hits = hits_.load();
+	stats.coalesced = coalesced_.load();
+	stats.misses = misses_.load();
+	stats.failures = failures_.load();
+	std::lock_guard<std::mutex> lock(m_);
+	stats.hosts = entries_.size();
+	return stats;
+}
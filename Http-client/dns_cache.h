@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+//   ,    .       
+// ,     ttl,    -  negativeTtl.  
+// ,          ,    .
+//     TTL ,     .
+// ,    timeout,   timed_out    .
+//       ,    DNS
+class DnsCache {
+public:
+	using Endpoints = std::vector<boost::asio::ip::tcp::endpoint>;
+	using Handler = std::function<void(boost::system::error_code, Endpoints)>;
+
+	struct Stats {
+		uint64_t hits = 0;       //   
+		uint64_t coalesced = 0;  // ,    
+		uint64_t misses = 0;     //   
+		uint64_t failures = 0;   //  
+		size_t hosts = 0;
+	};
+
+	// stub -  "=[,];...",   -  
+	DnsCache(boost::asio::io_context& ioc, std::chrono::seconds ttl, std::chrono::seconds negativeTtl,
+		std::chrono::seconds timeout, const std::string& stub);
+
+	// handler   executor  ( strand ),    
+	void resolve(const std::string& host, unsigned short port, boost::asio::any_io_executor executor, Handler handler);
+
+	//   ,          
+	void forget(const std::string& host);
+
+	Stats stats() const;
+
+	DnsCache(const DnsCache&) = delete;
+	DnsCache& operator=(const DnsCache&) = delete;
+
+private:
+	using Addresses = std::vector<boost::asio::ip::address>;
+
+	struct Waiter {
+		unsigned short port;
+		boost::asio::any_io_executor executor;
+		Handler handler;
+	};
+
+	struct Entry {
+		Addresses addresses;
+		boost::system::error_code ec;
+		std::chrono::steady_clock::time_point expires;
+		bool pending = false;
+		uint64_t lookup = 0;  //   :    
+		std::vector<Waiter> waiters;
+	};
+
+	boost::asio::io_context& ioc_;
+	const std::chrono::seconds ttl_;
+	const std::chrono::seconds negativeTtl_;
+	const std::chrono::seconds timeout_;
+	const bool stubMode_;
+	std::unordered_map<std::string, Addresses> stub_;
+
+	mutable std::mutex m_;
+	std::unordered_map<std::string, Entry> entries_;
+	uint64_t nextLookup_ = 0;
+
+	std::atomic<uint64_t> hits_{0};
+	std::atomic<uint64_t> coalesced_{0};
+	std::atomic<uint64_t> misses_{0};
+	std::atomic<uint64_t> failures_{0};
+
+	void lookup(const std::string& host, uint64_t id);
+	// false -  id   (   )
+	bool complete(const std::string& host, uint64_t id, boost::system::error_code ec, Addresses addresses);
+	static Endpoints endpoints(const Addresses& addresses, unsigned short port);
+};
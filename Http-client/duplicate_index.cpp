@@ -0,0 +1,167 @@
+#include "duplicate_index.h"
+
+#include <bitset>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+//        :  
+// (, )      
+constexpr size_t minTerms = 16;
+
+uint64_t fnv1a(const std::string& s)
+{
+	uint64_t h = 14695981039346656037ull;
+	for (unsigned char c : s) {
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+uint64_t mix(uint64_t x)
+{
+	//  splitmix64:  FNV    ,  SimHash  
+	x += 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+unsigned distance(uint64_t a, uint64_t b)
+{
+	return static_cast<unsigned>(std::bitset<64>(a ^ b).count());
+}
+
+}
+
+DuplicateIndex::DuplicateIndex(unsigned maxDistance)
+	: maxDistance_(std::min(maxDistance, 15u))
+{
+	//       64 
+	unsigned count = maxDistance_ + 1;
+	unsigned start = 0;
+	for (unsigned i = 0; i < count; i++) {
+		unsigned end = 64 * (i + 1) / count;
+		Block block;
+		block.shift = start;
+		block.mask = end - start == 64 ? ~0ull : ((1ull << (end - start)) - 1);
+		blocks_.push_back(std::move(block));
+		start = end;
+	}
+}
+
+uint64_t DuplicateIndex::fingerprint(const PageWords& page)
+{
+	//      :  ,  ,  
+	//    ,       
+	double weights[64] = {};
+	auto accumulate = [&](const std::string& word, size_t count) {
+		uint64_t h = mix(fnv1a(word));
+		double weight = 1.0 + std::log(static_cast<double>(count));
+		for (unsigned bit = 0; bit < 64; bit++) {
+			weights[bit] += (h >> bit) & 1 ? weight : -weight;
+		}
+	};
+
+	size_t terms = 0;
+	if (!page.positions.empty()) {
+		for (const auto& [word, positions] : page.positions) {
+			accumulate(word, positions.size());
+		}
+		terms = page.positions.size();
+	}
+	else {
+		for (const auto& [word, count] : page.wordsCount) {
+			accumulate(word, static_cast<size_t>(std::max(count, 1)));
+		}
+		terms = page.wordsCount.size();
+	}
+	if (terms < minTerms) {
+		return 0;
+	}
+
+	uint64_t result = 0;
+	for (unsigned bit = 0; bit < 64; bit++) {
+		if (weights[bit] > 0) {
+			result |= 1ull << bit;
+		}
+	}
+	return result;
+}
+
+std::optional<DuplicateIndex::Match> DuplicateIndex::findOrAdd(const std::string& url, uint64_t fingerprint)
+{
+	std::lock_guard<std::mutex> lock(m_);
+	stats_.lookups++;
+
+	auto own = byUrl_.find(url);
+	const Entry* best = nullptr;
+	unsigned bestDistance = maxDistance_ + 1;
+	for (const auto& block : blocks_) {
+		uint64_t key = (fingerprint >> block.shift) & block.mask;
+		auto bucket = block.table.find(key);
+		if (bucket == block.table.end()) {
+			continue;
+		}
+		for (uint32_t index : bucket->second) {
+			const Entry& entry = entries_[index];
+			if ((own != byUrl_.end() && own->second == index) || entry.url.empty()
+				|| ((entry.fingerprint >> block.shift) & block.mask) != key) {
+				continue; //   ( ),     
+			}
+			stats_.candidates++;
+			unsigned d = distance(entry.fingerprint, fingerprint);
+			if (d < bestDistance) {
+				best = &entry;
+				bestDistance = d;
+			}
+		}
+	}
+
+	if (best) {
+		stats_.duplicates++;
+		Match match{best->url, bestDistance};
+		if (own != byUrl_.end()) {
+			//      :      
+			entries_[own->second].url.clear();
+			byUrl_.erase(own);
+		}
+		return match;
+	}
+	insert(url, fingerprint);
+	return std::nullopt;
+}
+
+void DuplicateIndex::add(const std::string& url, uint64_t fingerprint)
+{
+	std::lock_guard<std::mutex> lock(m_);
+	insert(url, fingerprint);
+}
+
+void DuplicateIndex::insert(const std::string& url, uint64_t fingerprint)
+{
+	auto [it, inserted] = byUrl_.try_emplace(url, static_cast<uint32_t>(entries_.size()));
+	if (inserted) {
+		entries_.push_back({url, fingerprint});
+	}
+	else if (entries_[it->second].fingerprint == fingerprint) {
+		return;
+	}
+	else {
+		entries_[it->second].fingerprint = fingerprint; //     
+	}
+
+	for (auto& block : blocks_) {
+		block.table[(fingerprint >> block.shift) & block.mask].push_back(it->second);
+	}
+}
+
+DuplicateIndex::Stats DuplicateIndex::stats() const
+{
+	std::lock_guard<std::mutex> lock(m_);
+	Stats stats = stats_;
+	stats.pages = byUrl_.size();
+	return stats;
+}
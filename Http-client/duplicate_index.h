@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+#include "../DB-service/DB_service.h"
+
+//     (,   ,    ).
+//   - SimHash       :    
+//     .    maxDistance + 1 ,
+//      :      
+//  maxDistance ,        ,  
+//   ,       
+class DuplicateIndex {
+public:
+	struct Match {
+		std::string canonical;
+		unsigned distance = 0;
+	};
+
+	struct Stats {
+		size_t pages = 0;         //    
+		uint64_t lookups = 0;
+		uint64_t duplicates = 0;  // ,   
+		uint64_t candidates = 0;  // ,    
+	};
+
+	explicit DuplicateIndex(unsigned maxDistance);
+
+	// 0,         
+	static uint64_t fingerprint(const PageWords& page);
+
+	//      ;   , url  
+	std::optional<Match> findOrAdd(const std::string& url, uint64_t fingerprint);
+
+	//    
+	void add(const std::string& url, uint64_t fingerprint);
+
+	Stats stats() const;
+
+	DuplicateIndex(const DuplicateIndex&) = delete;
+	DuplicateIndex& operator=(const DuplicateIndex&) = delete;
+
+private:
+	struct Entry {
+		std::string url;
+		uint64_t fingerprint = 0;
+	};
+
+	struct Block {
+		unsigned shift = 0;
+		uint64_t mask = 0;
+		//  -  ,  -  .    
+		//     ,    
+		std::unordered_map<uint64_t, std::vector<uint32_t>> table;
+	};
+
+	const unsigned maxDistance_;
+	mutable std::mutex m_;
+	std::vector<Block> blocks_;
+	std::vector<Entry> entries_;
+	std::unordered_map<std::string, uint32_t> byUrl_;
+	Stats stats_;
+
+	void insert(const std::string& url, uint64_t fingerprint);
+};
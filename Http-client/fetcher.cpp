@@ -0,0 +1,458 @@
+#include "fetcher.h"
+
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <openssl/ssl.h>
+
+#include "decompressor.h"
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+
+using tcp = boost::asio::ip::tcp;
+
+//   : resolve -> connect -> (handshake) -> write -> read.
+//        ,   
+namespace {
+
+constexpr size_t bodyChunk = 64 * 1024;
+
+bool isTextContentType(beast::string_view contentType)
+{
+	if (contentType.empty()) {
+		return true; //   :      
+	}
+	return beast::iequals(contentType.substr(0, 5), "text/")
+		|| beast::iequals(contentType.substr(0, 21), "application/xhtml+xml")
+		|| beast::iequals(contentType.substr(0, 15), "application/xml");
+}
+
+}
+
+template <class Stream>
+class FetchSession : public std::enable_shared_from_this<FetchSession<Stream>>
+{
+	static constexpr bool isSsl = std::is_same_v<Stream, ConnectionPool::SslStream>;
+
+	Fetcher& owner_;
+	Fetcher::Handler handler_;
+	Fetcher::Validators validators_;
+	std::unique_ptr<Stream> stream_;
+	bool reused_ = false;
+	beast::flat_buffer buffer_;
+	http::request<http::empty_body> req_;
+	std::optional<http::response_parser<http::buffer_body>> parser_;
+	std::unique_ptr<Decompressor> decoder_;   //    
+	std::unique_ptr<char[]> compressed_;      //     
+	uint64_t wireBytes_ = 0;                  //  ,   
+	bool sniffed_ = false;
+	FetchResult result_;
+
+public:
+	FetchSession(Fetcher& owner, Link link, Fetcher::Handler handler, Fetcher::Validators validators)
+		: owner_(owner), handler_(std::move(handler)), validators_(std::move(validators))
+	{
+		result_.link = std::move(link);
+	}
+
+	void run()
+	{
+		const Link& link = result_.link;
+
+		req_ = {http::verb::get, link.query, 11};
+		req_.set(http::field::host, link.hostName);
+		req_.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+		req_.set(http::field::accept_encoding, Decompressor::acceptEncoding());
+		req_.keep_alive(true);
+		if (!validators_.etag.empty()) {
+			req_.set(http::field::if_none_match, validators_.etag);
+		}
+		if (!validators_.lastModified.empty()) {
+			req_.set(http::field::if_modified_since, validators_.lastModified);
+		}
+
+		stream_ = owner_.pool().acquire<Stream>(link.hostName);
+		if (stream_) {
+			reused_ = true;
+			sendRequest();
+		}
+		else {
+			connect();
+		}
+	}
+
+private:
+	void connect()
+	{
+		const Link& link = result_.link;
+
+		if constexpr (isSsl) {
+			stream_ = std::make_unique<Stream>(net::make_strand(owner_.context()), owner_.sslContext());
+			if (!SSL_set_tlsext_host_name(stream_->native_handle(), link.hostName.c_str())) {
+				finish(beast::error_code{static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()});
+				return;
+			}
+			owner_.pool().prepareSession(link.hostName, stream_->native_handle());
+		}
+		else {
+			stream_ = std::make_unique<Stream>(net::make_strand(owner_.context()));
+		}
+
+		owner_.dns().resolve(link.hostName, isSsl ? 443 : 80, stream_->get_executor(),
+			beast::bind_front_handler(&FetchSession::onResolve, this->shared_from_this()));
+	}
+
+	void onResolve(beast::error_code ec, DnsCache::Endpoints endpoints)
+	{
+		if (ec) {
+			return finish(ec);
+		}
+
+		beast::get_lowest_layer(*stream_).expires_after(owner_.timeout());
+		beast::get_lowest_layer(*stream_).async_connect(endpoints,
+			beast::bind_front_handler(&FetchSession::onConnect, this->shared_from_this()));
+	}
+
+	void onConnect(beast::error_code ec, tcp::endpoint)
+	{
+		if (ec) {
+			owner_.dns().forget(result_.link.hostName); //   :     
+			return finish(ec);
+		}
+
+		if constexpr (isSsl) {
+			beast::get_lowest_layer(*stream_).expires_after(owner_.timeout());
+			stream_->async_handshake(ssl::stream_base::client,
+				beast::bind_front_handler(&FetchSession::onHandshake, this->shared_from_this()));
+		}
+		else {
+			sendRequest();
+		}
+	}
+
+	void onHandshake(beast::error_code ec)
+	{
+		if (ec) {
+			return finish(ec);
+		}
+		sendRequest();
+	}
+
+	void sendRequest()
+	{
+		beast::get_lowest_layer(*stream_).expires_after(owner_.timeout());
+		http::async_write(*stream_, req_,
+			beast::bind_front_handler(&FetchSession::onWrite, this->shared_from_this()));
+	}
+
+	void onWrite(beast::error_code ec, std::size_t)
+	{
+		if (ec) {
+			return retryOrFinish(ec);
+		}
+
+		parser_.emplace();
+		parser_->body_limit((std::numeric_limits<std::uint64_t>::max)()); //    ,  
+
+		beast::get_lowest_layer(*stream_).expires_after(owner_.timeout());
+		http::async_read_header(*stream_, buffer_, *parser_,
+			beast::bind_front_handler(&FetchSession::onHeader, this->shared_from_this()));
+	}
+
+	void onHeader(beast::error_code ec, std::size_t bytes)
+	{
+		if (ec) {
+			if (bytes == 0) {
+				return retryOrFinish(ec);
+			}
+			return finish(ec);
+		}
+
+		if constexpr (isSsl) {
+			if (!reused_) {
+				owner_.pool().saveSession(result_.link.hostName, stream_->native_handle());
+			}
+		}
+
+		result_.header = parser_->get().base();
+
+		//      
+		if (result_.header.result() == http::status::ok && !isTextContentType(result_.header[http::field::content_type])) {
+			result_.binary = true;
+			return finish({});
+		}
+
+		auto encoding = Decompressor::parse(std::string_view(
+			result_.header[http::field::content_encoding].data(), result_.header[http::field::content_encoding].size()));
+		if (encoding == Decompressor::Encoding::Unsupported) {
+			result_.binary = true; //         
+			return finish({});
+		}
+
+		if (encoding != Decompressor::Encoding::Identity) {
+			decoder_ = std::make_unique<Decompressor>(encoding);
+			compressed_.reset(new char[bodyChunk]);
+		}
+		else if (auto length = parser_->content_length()) {
+			result_.body.reserve(static_cast<size_t>(std::min<uint64_t>(*length, owner_.maxPageSize())));
+		}
+		readBody();
+	}
+
+	void readBody()
+	{
+		if (parser_->is_done()) {
+			//    ,     
+			if (parser_->keep_alive() && !parser_->need_eof()) {
+				beast::get_lowest_layer(*stream_).expires_never();
+				owner_.pool().release(result_.link.hostName, std::move(stream_));
+			}
+			return finish({});
+		}
+
+		size_t offset = result_.body.size();
+		size_t room = std::min(bodyChunk, owner_.maxPageSize() - offset);
+		if (room == 0) {
+			result_.truncated = true; //    ,  
+			return finish({});
+		}
+
+		auto& body = parser_->get().body();
+		if (decoder_) {
+			//           
+			room = bodyChunk;
+			body.data = compressed_.get();
+		}
+		else {
+			//     ,   
+			result_.body.resize(offset + room);
+			body.data = &result_.body[offset];
+		}
+		body.size = room;
+		body.more = true;
+
+		beast::get_lowest_layer(*stream_).expires_after(owner_.timeout());
+		http::async_read_some(*stream_, buffer_, *parser_,
+			[self = this->shared_from_this(), offset, room](beast::error_code ec, std::size_t) {
+				self->onBody(ec, offset, room);
+			});
+	}
+
+	void onBody(beast::error_code ec, size_t offset, size_t room)
+	{
+		size_t received = room - parser_->get().body().size;
+		wireBytes_ += received;
+		if (!decoder_) {
+			result_.body.resize(offset + received);
+		}
+
+		if (ec == http::error::need_buffer) {
+			ec = {};
+		}
+		if (ec) {
+			return finish(ec);
+		}
+
+		if (decoder_ && received > 0) {
+			//   :      maxPageSize
+			uint64_t allowed = std::max<uint64_t>(wireBytes_ * owner_.maxCompressionRatio(), bodyChunk);
+			size_t limit = static_cast<size_t>(std::min<uint64_t>(allowed, owner_.maxPageSize()));
+
+			auto status = decoder_->write(std::string_view(compressed_.get(), received), result_.body, limit);
+			if (status == Decompressor::Status::Error) {
+				result_.body.clear();
+				return finish(make_error_code(boost::system::errc::illegal_byte_sequence));
+			}
+			if (status == Decompressor::Status::LimitReached) {
+				if (result_.body.size() >= owner_.maxPageSize()) {
+					result_.truncated = true;
+					return finish({});
+				}
+				result_.body.clear(); //    
+				return finish(make_error_code(boost::system::errc::value_too_large));
+			}
+		}
+
+		//      ,   
+		if (!sniffed_ && !result_.body.empty()) {
+			sniffed_ = true;
+			if (result_.header.result() == http::status::ok
+				&& std::memchr(result_.body.data(), 0, result_.body.size()) != nullptr) {
+				result_.binary = true;
+				result_.body.clear();
+				return finish({});
+			}
+		}
+
+		readBody();
+	}
+
+	//     :    
+	void retryOrFinish(beast::error_code ec)
+	{
+		if (!reused_) {
+			return finish(ec);
+		}
+		reused_ = false;
+		buffer_.clear();
+		decoder_.reset();
+		wireBytes_ = 0;
+		sniffed_ = false;
+		result_.header = {};
+		result_.body.clear();
+		connect();
+	}
+
+	void finish(beast::error_code ec)
+	{
+		if (stream_) {
+			beast::error_code ignored;
+			beast::get_lowest_layer(*stream_).socket().shutdown(tcp::socket::shutdown_both, ignored);
+		}
+		if (wireBytes_ > 0) {
+			owner_.recordTransfer(result_.link.hostName, wireBytes_, result_.body.size(), decoder_ != nullptr);
+		}
+		result_.ec = ec;
+		owner_.complete(handler_, std::move(result_));
+	}
+};
+
+Fetcher::Fetcher(const Config::Spider& settings)
+	: work_(net::make_work_guard(ioc_)), sslCtx_(ssl::context::tlsv13_client),
+	pool_(settings.maxIdlePerHost, std::chrono::seconds(settings.idleTimeout)),
+	dns_(ioc_, std::chrono::seconds(settings.dnsTtl), std::chrono::seconds(settings.dnsNegativeTtl),
+		std::chrono::seconds(settings.fetchTimeout), settings.dnsStub),
+	evictTimer_(net::make_strand(ioc_)),
+	maxInFlight_(settings.maxInFlight > 0 ? settings.maxInFlight : 1),
+	maxPageSize_(settings.maxPageSize),
+	maxCompressionRatio_(settings.maxCompressionRatio > 0 ? settings.maxCompressionRatio : 1),
+	timeout_(settings.fetchTimeout)
+{
+	sslCtx_.set_default_verify_paths(); //       
+	sslCtx_.set_verify_mode(ssl::verify_none);
+	//       TLS   
+	SSL_CTX_set_session_cache_mode(sslCtx_.native_handle(), SSL_SESS_CACHE_CLIENT);
+
+	scheduleEviction();
+
+	size_t ioThreads = settings.ioThreads;
+
+	if (ioThreads == 0) {
+		ioThreads = 1;
+	}
+	for (size_t i = 0; i < ioThreads; i++) {
+		threads_.emplace_back([this] { ioc_.run(); });
+	}
+}
+
+Fetcher::~Fetcher()
+{
+	stop();
+}
+
+void Fetcher::stop()
+{
+	net::post(evictTimer_.get_executor(), [this] {
+		stopping_ = true;
+		evictTimer_.cancel();
+		});
+	work_.reset();
+	for (auto& thread : threads_) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+}
+
+void Fetcher::scheduleEviction()
+{
+	evictTimer_.expires_after(std::chrono::seconds(1));
+	evictTimer_.async_wait([this](beast::error_code ec) {
+		if (ec || stopping_) {
+			return;
+		}
+		pool_.evictIdle();
+		scheduleEviction();
+		});
+}
+
+void Fetcher::fetch(const Link& link, Handler handler, Validators validators)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		if (inFlight_ >= maxInFlight_) {
+			waiting_.push_back({link, std::move(handler), std::move(validators)}); //   
+			return;
+		}
+		inFlight_++;
+	}
+	start({link, std::move(handler), std::move(validators)});
+}
+
+void Fetcher::start(Request&& request)
+{
+	if (request.link.protocol == ProtocolType::HTTPS) {
+		auto session = std::make_shared<FetchSession<ConnectionPool::SslStream>>(
+			*this, std::move(request.link), std::move(request.handler), std::move(request.validators));
+		session->run();
+	}
+	else {
+		auto session = std::make_shared<FetchSession<ConnectionPool::TcpStream>>(
+			*this, std::move(request.link), std::move(request.handler), std::move(request.validators));
+		session->run();
+	}
+}
+
+void Fetcher::recordTransfer(const std::string& host, uint64_t wireBytes, uint64_t bodyBytes, bool compressed)
+{
+	std::lock_guard<std::mutex> lock(statsMutex_);
+	auto& stats = transfer_[host];
+	stats.responses++;
+	if (compressed) {
+		stats.compressedResponses++;
+	}
+	stats.wireBytes += wireBytes;
+	stats.bodyBytes += bodyBytes;
+}
+
+std::unordered_map<std::string, Fetcher::TransferStats> Fetcher::transferStats() const
+{
+	std::lock_guard<std::mutex> lock(statsMutex_);
+	return transfer_;
+}
+
+void Fetcher::complete(Handler& handler, FetchResult&& result)
+{
+	try {
+		handler(std::move(result));
+	}
+	catch (const std::exception& e) {
+		std::cout << e.what() << std::endl;
+	}
+
+	//  :    
+	Request next;
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		if (waiting_.empty()) {
+			inFlight_--;
+			return;
+		}
+		next = std::move(waiting_.front());
+		waiting_.pop_front();
+	}
+	start(std::move(next));
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "link.h"
+#include "connection_pool.h"
+#include "dns_cache.h"
+#include "../Config/config.h"
+
+//   .      body ( - 
+//  )   maxPageSize,        
+struct FetchResult {
+	Link link;
+	boost::beast::error_code ec;
+	boost::beast::http::response_header<> header;
+	std::string body;
+	bool binary = false;     //    ,   
+	bool truncated = false;  //   maxPageSize    
+};
+
+//   :      io_context
+//    ,    .
+//      ConnectionPool,   -  DnsCache
+class Fetcher {
+public:
+	using Handler = std::function<void(FetchResult&&)>;
+
+	//   :        
+	//   304  
+	struct Validators {
+		std::string etag;
+		std::string lastModified;
+	};
+
+	//     :         
+	struct TransferStats {
+		uint64_t responses = 0;
+		uint64_t compressedResponses = 0;
+		uint64_t wireBytes = 0;
+		uint64_t bodyBytes = 0;
+	};
+
+	explicit Fetcher(const Config::Spider& settings);
+	~Fetcher();
+
+	// handler    io_context,     
+	void fetch(const Link& link, Handler handler, Validators validators = {});
+	void stop();
+
+	std::chrono::seconds timeout() const { return timeout_; }
+	size_t maxPageSize() const { return maxPageSize_; }
+	size_t maxCompressionRatio() const { return maxCompressionRatio_; }
+	boost::asio::io_context& context() { return ioc_; }
+	boost::asio::ssl::context& sslContext() { return sslCtx_; }
+	ConnectionPool& pool() { return pool_; }
+	DnsCache& dns() { return dns_; }
+	std::unordered_map<std::string, TransferStats> transferStats() const;
+
+	Fetcher(const Fetcher&) = delete;
+	Fetcher& operator=(const Fetcher&) = delete;
+
+private:
+	struct Request {
+		Link link;
+		Handler handler;
+		Validators validators;
+	};
+
+	boost::asio::io_context ioc_;
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+	boost::asio::ssl::context sslCtx_;
+	ConnectionPool pool_;
+	DnsCache dns_;
+	boost::asio::steady_timer evictTimer_;
+	bool stopping_ = false;
+	std::vector<std::thread> threads_;
+
+	const size_t maxInFlight_;
+	const size_t maxPageSize_;
+	const size_t maxCompressionRatio_;
+	const std::chrono::seconds timeout_;
+
+	std::mutex m_;
+	std::deque<Request> waiting_;
+	size_t inFlight_ = 0;
+
+	mutable std::mutex statsMutex_;
+	std::unordered_map<std::string, TransferStats> transfer_;
+
+	void scheduleEviction();
+	void start(Request&& request);
+	void recordTransfer(const std::string& host, uint64_t wireBytes, uint64_t bodyBytes, bool compressed);
+	void complete(Handler& handler, FetchResult&& result);
+
+	template <class Stream> friend class FetchSession;
+};
@@ -0,0 +1,249 @@
+#include "frontier.h"
+
+#include <cmath>
+#include <algorithm>
+#include <cctype>
+
+#include "http_utils.h"
+
+namespace {
+
+uint64_t fnv1a(const std::string& s)
+{
+	uint64_t h = 14695981039346656037ull;
+	for (unsigned char c : s) {
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+uint64_t mix(uint64_t x)
+{
+	//  splitmix64:      
+	x += 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+//   "."  ".."  
+std::string removeDotSegments(const std::string& path)
+{
+	std::vector<std::string> segments;
+	size_t pos = 1;
+	while (pos <= path.size()) {
+		size_t next = path.find('/', pos);
+		if (next == std::string::npos) {
+			next = path.size();
+		}
+		std::string segment = path.substr(pos, next - pos);
+		if (segment == "..") {
+			if (!segments.empty()) {
+				segments.pop_back();
+			}
+			if (next == path.size()) {
+				segments.emplace_back();
+			}
+		}
+		else if (segment == ".") {
+			if (next == path.size()) {
+				segments.emplace_back();
+			}
+		}
+		else {
+			segments.push_back(std::move(segment));
+		}
+		pos = next + 1;
+	}
+
+	std::string result;
+	for (const auto& segment : segments) {
+		result += '/';
+		result += segment;
+	}
+	return result.empty() ? "/" : result;
+}
+
+}
+
+BloomFilter::BloomFilter(size_t capacity, double errorRate)
+	: capacity_(capacity > 0 ? capacity : 1)
+{
+	const double ln2 = std::log(2.0);
+	double bits = -static_cast<double>(capacity_) * std::log(errorRate) / (ln2 * ln2);
+	bitCount_ = static_cast<size_t>(std::ceil(bits / 64.0)) * 64;
+	hashes_ = static_cast<unsigned>(std::max(1.0, std::round(bits / capacity_ * ln2)));
+	bits_.assign(bitCount_ / 64, 0);
+}
+
+bool BloomFilter::contains(uint64_t h1, uint64_t h2) const
+{
+	for (unsigned i = 0; i < hashes_; i++) {
+		size_t bit = (h1 + i * h2) % bitCount_;
+		if ((bits_[bit / 64] & (1ull << (bit % 64))) == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void BloomFilter::insert(uint64_t h1, uint64_t h2)
+{
+	for (unsigned i = 0; i < hashes_; i++) {
+		size_t bit = (h1 + i * h2) % bitCount_;
+		bits_[bit / 64] |= 1ull << (bit % 64);
+	}
+	count_++;
+}
+
+ScalableBloomFilter::ScalableBloomFilter(size_t initialCapacity, double errorRate)
+{
+	//    p/2 + p/4 + ...   errorRate
+	filters_.emplace_back(initialCapacity, errorRate / 2);
+	nextErrorRate_ = errorRate / 4;
+}
+
+bool ScalableBloomFilter::contains(uint64_t h1, uint64_t h2) const
+{
+	for (auto it = filters_.rbegin(); it != filters_.rend(); ++it) {
+		if (it->contains(h1, h2)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void ScalableBloomFilter::insert(uint64_t h1, uint64_t h2)
+{
+	if (filters_.back().full()) {
+		filters_.emplace_back(filters_.back().capacity() * 2, nextErrorRate_);
+		nextErrorRate_ /= 2;
+	}
+	filters_.back().insert(h1, h2);
+}
+
+size_t ScalableBloomFilter::memory() const
+{
+	size_t total = 0;
+	for (const auto& filter : filters_) {
+		total += filter.memory();
+	}
+	return total;
+}
+
+Frontier::Frontier(size_t expectedUrls, size_t exactLimit)
+	: exactPerShard_(exactLimit / shardCount)
+{
+	//         
+	size_t perShard = std::max<size_t>(expectedUrls / shardCount, 1024);
+	shards_.reserve(shardCount);
+	for (size_t i = 0; i < shardCount; i++) {
+		shards_.push_back(std::make_unique<Shard>(perShard));
+	}
+}
+
+Link Frontier::canonicalize(const Link& link)
+{
+	Link result;
+	result.protocol = link.protocol;
+
+	//     ,       
+	result.hostName.reserve(link.hostName.size());
+	for (unsigned char c : link.hostName) {
+		result.hostName += static_cast<char>(std::tolower(c));
+	}
+	if (!result.hostName.empty() && result.hostName.back() == '.') {
+		result.hostName.pop_back();
+	}
+	const char* defaultPort = link.protocol == ProtocolType::HTTPS ? ":443" : ":80";
+	size_t portPos = result.hostName.rfind(defaultPort);
+	if (portPos != std::string::npos && portPos + std::char_traits<char>::length(defaultPort) == result.hostName.size()) {
+		result.hostName.erase(portPos);
+	}
+
+	//      
+	//       ,   
+	std::string query = link.query.substr(0, link.query.find('#'));
+	if (query.empty() || query[0] != '/') {
+		query.insert(query.begin(), '/');
+	}
+
+	size_t argsPos = query.find('?');
+	std::string path = removeDotSegments(query.substr(0, argsPos));
+	std::string args = argsPos == std::string::npos ? "" : query.substr(argsPos);
+
+	//    %XX    
+	result.query.reserve(path.size() + args.size());
+	const std::string full = path + args;
+	for (size_t i = 0; i < full.size(); i++) {
+		if (full[i] == '%' && i + 2 < full.size()
+			&& std::isxdigit(static_cast<unsigned char>(full[i + 1]))
+			&& std::isxdigit(static_cast<unsigned char>(full[i + 2]))) {
+			result.query += '%';
+			result.query += static_cast<char>(std::toupper(static_cast<unsigned char>(full[i + 1])));
+			result.query += static_cast<char>(std::toupper(static_cast<unsigned char>(full[i + 2])));
+			i += 2;
+		}
+		else {
+			result.query += full[i];
+		}
+	}
+
+	return result;
+}
+
+bool Frontier::tryVisit(Link& link, int depth)
+{
+	submitted_++;
+
+	link = canonicalize(link);
+	const std::string text = getLinkText(link);
+	const uint64_t h1 = mix(fnv1a(text)); //   FNV  
+	const uint64_t h2 = mix(h1) | 1;
+
+	Shard& shard = *shards_[mix(h1 ^ 0x5bd1e995u) % shardCount];
+	std::lock_guard<std::mutex> lock(shard.m);
+
+	if (shard.bloom.contains(h1, h2)) {
+		auto it = shard.exact.find(h1);
+		if (it != shard.exact.end()) {
+			bloomChecks_++;
+			if (depth <= it->second) {
+				return false;
+			}
+			it->second = depth;
+			readmitted_++;
+			scheduled_++;
+			return true;
+		}
+		if (shard.exact.size() >= exactPerShard_) {
+			return false; //        
+		}
+		bloomChecks_++; //   
+	}
+
+	shard.bloom.insert(h1, h2);
+	if (shard.exact.size() < exactPerShard_) {
+		shard.exact.emplace(h1, depth);
+	}
+	scheduled_++;
+	return true;
+}
+
+Frontier::Stats Frontier::stats() const
+{
+	Stats s;
+	s.submitted = submitted_;
+	s.scheduled = scheduled_;
+	s.readmitted = readmitted_;
+	s.duplicates = s.submitted - s.scheduled;
+	s.bloomChecks = bloomChecks_;
+	for (const auto& shard : shards_) {
+		std::lock_guard<std::mutex> lock(shard->m);
+		s.memory += shard->bloom.memory();
+		//   ,     ,   
+		s.memory += shard->exact.size() * (sizeof(uint64_t) + sizeof(int) + sizeof(void*)) + shard->exact.bucket_count() * sizeof(void*);
+	}
+	return s;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "link.h"
+
+//     ( )
+class BloomFilter {
+public:
+	BloomFilter(size_t capacity, double errorRate);
+
+	bool contains(uint64_t h1, uint64_t h2) const;
+	void insert(uint64_t h1, uint64_t h2);
+
+	bool full() const { return count_ >= capacity_; }
+	size_t capacity() const { return capacity_; }
+	size_t memory() const { return bits_.size() * sizeof(uint64_t); }
+
+private:
+	std::vector<uint64_t> bits_;
+	size_t bitCount_;
+	unsigned hashes_;
+	size_t capacity_;
+	size_t count_ = 0;
+};
+
+//   :      
+//      ,    
+class ScalableBloomFilter {
+public:
+	ScalableBloomFilter(size_t initialCapacity, double errorRate);
+
+	bool contains(uint64_t h1, uint64_t h2) const;
+	void insert(uint64_t h1, uint64_t h2);
+	size_t memory() const;
+
+private:
+	std::vector<BloomFilter> filters_;
+	double nextErrorRate_;
+};
+
+//  :        
+// .     exactLimit ,
+//       .    
+//     : ,   ,
+//  ,         
+class Frontier {
+public:
+	struct Stats {
+		size_t submitted = 0;    //   
+		size_t scheduled = 0;    //   
+		size_t readmitted = 0;   //        
+		size_t duplicates = 0;   //   
+		size_t bloomChecks = 0;  //   ,    
+		size_t memory = 0;       //       ()
+	};
+
+	Frontier(size_t expectedUrls, size_t exactLimit);
+
+	//  true,         , 
+	//  ; link    
+	bool tryVisit(Link& link, int depth);
+
+	static Link canonicalize(const Link& link);
+
+	Stats stats() const;
+
+	Frontier(const Frontier&) = delete;
+	Frontier& operator=(const Frontier&) = delete;
+
+private:
+	static constexpr size_t shardCount = 64;
+
+	struct Shard {
+		std::mutex m;
+		ScalableBloomFilter bloom;
+		std::unordered_map<uint64_t, int> exact;  //   -  ,    
+
+		Shard(size_t capacity) : bloom(capacity, 0.001) {}
+	};
+
+	std::vector<std::unique_ptr<Shard>> shards_;
+	const size_t exactPerShard_;
+
+	std::atomic<size_t> submitted_{0};
+	std::atomic<size_t> scheduled_{0};
+	std::atomic<size_t> readmitted_{0};
+	std::atomic<size_t> bloomChecks_{0};
+};
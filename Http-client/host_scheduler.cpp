@@ -0,0 +1,217 @@
+#include "host_scheduler.h"
+
+#include <algorithm>
+#include <optional>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+//   ,    
+constexpr auto backoffStep = std::chrono::milliseconds(250);
+
+//    1970-01-01     
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day)
+{
+	year -= month <= 2;
+	int64_t era = (year >= 0 ? year : year - 399) / 400;
+	unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+	unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+// Retry-After:       HTTP ("Sun, 06 Nov 1994 08:49:37 GMT")
+std::optional<std::chrono::seconds> parseRetryAfter(std::string_view value)
+{
+	while (!value.empty() && value.front() == ' ') {
+		value.remove_prefix(1);
+	}
+	if (value.empty()) {
+		return std::nullopt;
+	}
+
+	if (std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+		int64_t seconds = 0;
+		for (char c : value.substr(0, 9)) {
+			seconds = seconds * 10 + (c - '0');
+		}
+		return std::chrono::seconds(seconds);
+	}
+
+	std::string text(value);
+	char monthName[4] = {};
+	int day = 0, year = 0, hour = 0, minute = 0, second = 0;
+	if (std::sscanf(text.c_str(), "%*3s, %d %3s %d %d:%d:%d", &day, monthName, &year, &hour, &minute, &second) != 6) {
+		return std::nullopt;
+	}
+	static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+	auto month = std::find_if(std::begin(months), std::end(months),
+		[&](const char* name) { return std::strcmp(name, monthName) == 0; });
+	if (month == std::end(months)) {
+		return std::nullopt;
+	}
+
+	int64_t at = daysFromCivil(year, static_cast<unsigned>(month - std::begin(months) + 1), day) * 86400
+		+ hour * 3600 + minute * 60 + second;
+	int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	return std::chrono::seconds(std::max<int64_t>(at - now, 0));
+}
+
+}
+
+HostScheduler::HostScheduler(const Config::Spider& settings)
+	: maxInFlight_(settings.maxInFlight > 0 ? settings.maxInFlight : 1),
+	hostConnections_(settings.hostConnections > 0 ? settings.hostConnections : 1),
+	minDelay_(std::chrono::milliseconds(std::max(settings.hostDelay, 0))),
+	maxDelay_(std::max<Clock::duration>(std::chrono::seconds(settings.maxHostDelay), minDelay_)),
+	maxRetries_(settings.throttleRetries)
+{
+}
+
+bool HostScheduler::push(Task&& task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		if (closed_) {
+			return false;
+		}
+
+		auto inserted = hosts_.try_emplace(task.link.hostName);
+		Host& host = inserted.first->second;
+		if (inserted.second) {
+			host.delay = minDelay_;
+		}
+		host.queue.push_back(std::move(task));
+		stats_.queued++;
+		stats_.maxQueued = std::max(stats_.maxQueued, stats_.queued);
+		schedule(host);
+	}
+	changed_.notify_all();
+	return true;
+}
+
+bool HostScheduler::pop(Task& task)
+{
+	std::unique_lock<std::mutex> lock(m_);
+	for (;;) {
+		if (closed_) {
+			return false;
+		}
+		if (inFlight_ >= maxInFlight_ || ready_.empty()) {
+			changed_.wait(lock);
+			continue;
+		}
+
+		Ready top = ready_.top();
+		Host& host = *top.host;
+		if (host.nextAllowed > top.at) {
+			//  ,     :    
+			ready_.pop();
+			ready_.push({host.nextAllowed, top.host});
+			continue;
+		}
+
+		auto now = Clock::now();
+		if (top.at > now) {
+			changed_.wait_until(lock, top.at); //     
+			continue;
+		}
+
+		ready_.pop();
+		host.ready = false;
+		task = std::move(host.queue.front());
+		host.queue.pop_front();
+		host.inFlight++;
+		host.nextAllowed = now + host.delay;
+		inFlight_++;
+		stats_.queued--;
+		schedule(host);
+		return true;
+	}
+}
+
+bool HostScheduler::complete(Task& task, unsigned status, std::string_view retryAfter)
+{
+	bool retry = false;
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		Host& host = hosts_[task.link.hostName];
+		host.inFlight--;
+		inFlight_--;
+
+		bool throttled = status == 429 || status == 503;
+		if (throttled || !retryAfter.empty()) {
+			slowDown(host, status, retryAfter);
+		}
+		else if (status != 0) {
+			//   :     
+			host.delay = std::max(minDelay_, host.delay - host.delay / 4);
+		}
+
+		if (throttled) {
+			stats_.throttled++;
+			if (task.attempts < maxRetries_) {
+				task.attempts++;
+				host.queue.push_front(std::move(task));
+				stats_.queued++;
+				stats_.retried++;
+				retry = true;
+			}
+			else {
+				stats_.dropped++;
+			}
+		}
+		schedule(host);
+	}
+	changed_.notify_all(); //   
+	return retry;
+}
+
+void HostScheduler::slowDown(Host& host, unsigned status, std::string_view retryAfter)
+{
+	Clock::duration pause{};
+	if (status == 429 || status == 503) {
+		host.delay = std::min(std::max<Clock::duration>(host.delay * 2, backoffStep), maxDelay_);
+		pause = host.delay;
+	}
+	if (auto hinted = parseRetryAfter(retryAfter)) {
+		pause = std::max<Clock::duration>(pause, std::min<Clock::duration>(*hinted, maxDelay_));
+	}
+	host.nextAllowed = std::max(host.nextAllowed, Clock::now() + pause);
+}
+
+void HostScheduler::schedule(Host& host)
+{
+	if (host.ready || host.queue.empty() || host.inFlight >= hostConnections_) {
+		return;
+	}
+	host.ready = true;
+	ready_.push({host.nextAllowed, &host});
+}
+
+void HostScheduler::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		closed_ = true;
+	}
+	changed_.notify_all();
+}
+
+HostScheduler::Stats HostScheduler::stats() const
+{
+	std::lock_guard<std::mutex> lock(m_);
+	Stats stats = stats_;
+	stats.hosts = hosts_.size();
+	stats.inFlight = inFlight_;
+	for (const auto& [name, host] : hosts_) {
+		auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(host.delay);
+		if (stats.slowestHost.empty() || delay > stats.slowestDelay) {
+			stats.slowestHost = name;
+			stats.slowestDelay = delay;
+		}
+	}
+	return stats;
+}
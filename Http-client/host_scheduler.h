@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+#include "link.h"
+#include "../Config/config.h"
+
+//       :     , 
+//       . ,   
+// ,     ,     ,  pop
+//   ,    ,     
+// .  429/503  Retry-After   ,    - 
+//   
+class HostScheduler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Task {
+		Link link;
+		int depth = 0;
+		size_t attempts = 0;  //         429/503
+	};
+
+	struct Stats {
+		size_t hosts = 0;
+		size_t queued = 0;
+		size_t maxQueued = 0;
+		size_t inFlight = 0;
+		uint64_t throttled = 0;  //  429/503
+		uint64_t retried = 0;    // ,     429/503
+		uint64_t dropped = 0;    // ,    
+		std::string slowestHost;
+		std::chrono::milliseconds slowestDelay{0};
+	};
+
+	explicit HostScheduler(const Config::Spider& settings);
+
+	// false,   
+	bool push(Task&& task);
+
+	//  ,     ; false,   
+	bool pop(Task& task);
+
+	//  task : status -   (0 -  ), retryAfter -  .
+	// true,           
+	bool complete(Task& task, unsigned status, std::string_view retryAfter);
+
+	void close();
+
+	Stats stats() const;
+
+	HostScheduler(const HostScheduler&) = delete;
+	HostScheduler& operator=(const HostScheduler&) = delete;
+
+private:
+	struct Host {
+		std::deque<Task> queue;
+		size_t inFlight = 0;
+		Clock::time_point nextAllowed;  //        
+		Clock::duration delay{};        //    
+		bool ready = false;             //    
+	};
+
+	struct Ready {
+		Clock::time_point at;
+		Host* host;
+
+		bool operator>(const Ready& other) const { return at > other.at; }
+	};
+
+	const size_t maxInFlight_;
+	const size_t hostConnections_;
+	const Clock::duration minDelay_;
+	const Clock::duration maxDelay_;
+	const size_t maxRetries_;
+
+	mutable std::mutex m_;
+	std::condition_variable changed_;
+	std::unordered_map<std::string, Host> hosts_;
+	std::priority_queue<Ready, std::vector<Ready>, std::greater<Ready>> ready_;
+	size_t inFlight_ = 0;
+	bool closed_ = false;
+	Stats stats_;
+
+	void schedule(Host& host);
+	void slowDown(Host& host, unsigned status, std::string_view retryAfter);
+};
@@ -0,0 +1,342 @@
+#include "html_tokenizer.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr size_t maxNameLength = 16;   //       
+constexpr size_t maxEntityLength = 32;
+
+inline bool isSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+inline bool isAlpha(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+inline char toLower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+void appendName(std::string& name, char c)
+{
+	if (name.size() < maxNameLength) {
+		name += toLower(c);
+	}
+}
+
+}
+
+HtmlTokenizer::HtmlTokenizer(TextHandler onText, LinkHandler onLink)
+	: onText_(std::move(onText)), onLink_(std::move(onLink))
+{
+}
+
+void HtmlTokenizer::emitText(std::string_view chunk, size_t begin, size_t end)
+{
+	if (!onText_) {
+		return;
+	}
+	if (text_.empty()) {
+		//     :   
+		if (end > begin) {
+			onText_(chunk.substr(begin, end - begin));
+		}
+		return;
+	}
+	text_.append(chunk.data() + begin, end - begin);
+	onText_(text_);
+	text_.clear();
+}
+
+void HtmlTokenizer::endAttribute()
+{
+	if (onLink_ && tagName_ == "a" && attrName_ == "href" && !attrValue_.empty()) {
+		//     &amp;  &
+		size_t pos = 0;
+		while ((pos = attrValue_.find("&amp;", pos)) != std::string::npos) {
+			attrValue_.erase(pos + 1, 4);
+			pos++;
+		}
+		onLink_(attrValue_);
+	}
+	attrName_.clear();
+	attrValue_.clear();
+}
+
+void HtmlTokenizer::endTag()
+{
+	if (!endTag_ && (tagName_ == "script" || tagName_ == "style")) {
+		rawEnd_ = "</" + tagName_;
+		rawMatched_ = 0;
+		state_ = State::RawText;
+		return;
+	}
+	state_ = State::Text;
+}
+
+void HtmlTokenizer::feed(std::string_view chunk)
+{
+	const char* data = chunk.data();
+	const size_t size = chunk.size();
+	size_t textStart = 0;
+	size_t i = 0;
+
+	while (i < size) {
+		char c = data[i];
+
+		switch (state_) {
+		case State::Text: {
+			//    
+			size_t j = i;
+			while (j < size && data[j] != '<' && data[j] != '&') {
+				j++;
+			}
+			if (j == size) {
+				text_.append(data + textStart, size - textStart);
+				return;
+			}
+			emitText(chunk, textStart, j);
+			state_ = data[j] == '<' ? State::TagOpen : State::Entity;
+			entityLength_ = 0;
+			i = j + 1;
+			continue;
+		}
+
+		case State::Entity:
+			if ((isAlpha(c) || (c >= '0' && c <= '9') || c == '#') && entityLength_ < maxEntityLength) {
+				entityLength_++;
+				i++;
+			}
+			else {
+				if (c == ';') {
+					i++;
+				}
+				state_ = State::Text;
+				textStart = i;
+			}
+			continue;
+
+		case State::TagOpen:
+			tagName_.clear();
+			attrName_.clear();
+			attrValue_.clear();
+			endTag_ = false;
+			if (isAlpha(c)) {
+				appendName(tagName_, c);
+				state_ = State::TagName;
+			}
+			else if (c == '/') {
+				endTag_ = true;
+				state_ = State::EndTagName;
+			}
+			else if (c == '!') {
+				state_ = State::MarkupDeclaration;
+			}
+			else if (c == '?') {
+				state_ = State::SkipTag;
+			}
+			else {
+				//  '<'  
+				state_ = State::Text;
+				textStart = i;
+				continue;
+			}
+			i++;
+			continue;
+
+		case State::TagName:
+			if (isSpace(c)) {
+				state_ = State::BeforeAttrName;
+			}
+			else if (c == '>') {
+				i++;
+				endTag();
+				textStart = i;
+				continue;
+			}
+			else if (c != '/') {
+				appendName(tagName_, c);
+			}
+			i++;
+			continue;
+
+		case State::EndTagName:
+			if (c == '>') {
+				i++;
+				state_ = State::Text;
+				textStart = i;
+				continue;
+			}
+			i++;
+			continue;
+
+		case State::BeforeAttrName:
+			if (c == '>') {
+				i++;
+				endTag();
+				textStart = i;
+				continue;
+			}
+			if (!isSpace(c) && c != '/') {
+				attrName_.clear();
+				attrValue_.clear();
+				appendName(attrName_, c);
+				state_ = State::AttrName;
+			}
+			i++;
+			continue;
+
+		case State::AttrName:
+			if (c == '=') {
+				state_ = State::BeforeAttrValue;
+			}
+			else if (isSpace(c)) {
+				state_ = State::AfterAttrName;
+			}
+			else if (c == '>' || c == '/') {
+				endAttribute();
+				state_ = State::BeforeAttrName;
+				continue;
+			}
+			else {
+				appendName(attrName_, c);
+			}
+			i++;
+			continue;
+
+		case State::AfterAttrName:
+			if (c == '=') {
+				state_ = State::BeforeAttrValue;
+			}
+			else if (!isSpace(c)) {
+				//   
+				endAttribute();
+				state_ = State::BeforeAttrName;
+				continue;
+			}
+			i++;
+			continue;
+
+		case State::BeforeAttrValue:
+			if (c == '"' || c == '\'') {
+				quote_ = c;
+				state_ = State::AttrValueQuoted;
+			}
+			else if (c == '>') {
+				endAttribute();
+				state_ = State::BeforeAttrName;
+				continue;
+			}
+			else if (!isSpace(c)) {
+				state_ = State::AttrValueUnquoted;
+				continue;
+			}
+			i++;
+			continue;
+
+		case State::AttrValueQuoted: {
+			const char* end = static_cast<const char*>(std::memchr(data + i, quote_, size - i));
+			size_t j = end ? static_cast<size_t>(end - data) : size;
+			if (tagName_ == "a" && attrName_ == "href") {
+				attrValue_.append(data + i, j - i);
+			}
+			if (!end) {
+				return;
+			}
+			endAttribute();
+			state_ = State::BeforeAttrName;
+			i = j + 1;
+			continue;
+		}
+
+		case State::AttrValueUnquoted:
+			if (isSpace(c) || c == '>') {
+				endAttribute();
+				state_ = State::BeforeAttrName;
+				continue;
+			}
+			if (tagName_ == "a" && attrName_ == "href") {
+				attrValue_ += c;
+			}
+			i++;
+			continue;
+
+		case State::MarkupDeclaration:
+			state_ = c == '-' ? State::MarkupDeclarationDash : State::SkipTag;
+			continue;
+
+		case State::MarkupDeclarationDash:
+			if (c == '-') {
+				i++;
+				commentDashes_ = 0;
+				state_ = State::Comment;
+			}
+			else {
+				state_ = State::SkipTag;
+			}
+			continue;
+
+		case State::Comment:
+			if (c == '>' && commentDashes_ >= 2) {
+				i++;
+				state_ = State::Text;
+				textStart = i;
+				continue;
+			}
+			commentDashes_ = c == '-' ? commentDashes_ + 1 : 0;
+			i++;
+			continue;
+
+		case State::SkipTag: {
+			const char* end = static_cast<const char*>(std::memchr(data + i, '>', size - i));
+			if (!end) {
+				return;
+			}
+			i = static_cast<size_t>(end - data) + 1;
+			state_ = State::Text;
+			textStart = i;
+			continue;
+		}
+
+		case State::RawText:
+			if (rawMatched_ == 0) {
+				const char* open = static_cast<const char*>(std::memchr(data + i, '<', size - i));
+				if (!open) {
+					return;
+				}
+				i = static_cast<size_t>(open - data) + 1;
+				rawMatched_ = 1;
+				continue;
+			}
+			//      ,     
+			if (toLower(c) == rawEnd_[rawMatched_]) {
+				if (++rawMatched_ == rawEnd_.size()) {
+					state_ = State::SkipTag;
+				}
+			}
+			else {
+				rawMatched_ = c == '<' ? 1 : 0;
+			}
+			i++;
+			continue;
+		}
+	}
+
+	if (state_ == State::Text && textStart < size) {
+		text_.append(data + textStart, size - textStart);
+	}
+}
+
+void HtmlTokenizer::finish()
+{
+	if (!text_.empty() && onText_) {
+		onText_(text_);
+	}
+	text_.clear();
+	state_ = State::Text;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+
+//    HTML.    
+//  onText,  href  <a> -  onLink.  <script>/<style>,
+//      (&amp;  ..) .
+//         
+class HtmlTokenizer {
+public:
+	using TextHandler = std::function<void(std::string_view)>;
+	using LinkHandler = std::function<void(std::string_view)>;
+
+	HtmlTokenizer(TextHandler onText, LinkHandler onLink);
+
+	void feed(std::string_view chunk);
+	void finish();
+
+private:
+	enum class State {
+		Text,
+		Entity,
+		TagOpen,
+		TagName,
+		EndTagName,
+		BeforeAttrName,
+		AttrName,
+		AfterAttrName,
+		BeforeAttrValue,
+		AttrValueQuoted,
+		AttrValueUnquoted,
+		MarkupDeclaration,
+		MarkupDeclarationDash,
+		Comment,
+		SkipTag,
+		RawText
+	};
+
+	TextHandler onText_;
+	LinkHandler onLink_;
+
+	State state_ = State::Text;
+	std::string text_;         //      
+	std::string tagName_;
+	std::string attrName_;
+	std::string attrValue_;
+	char quote_ = 0;
+	bool endTag_ = false;
+	size_t entityLength_ = 0;
+	size_t commentDashes_ = 0;
+	std::string rawEnd_;       // "</script"  "</style"
+	size_t rawMatched_ = 0;
+
+	void emitText(std::string_view chunk, size_t begin, size_t end);
+	void endAttribute();
+	void endTag();
+};
@@ -0,0 +1,153 @@
+#include "index_batcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+constexpr int writeAttempts = 3;
+constexpr auto retryPause = std::chrono::seconds(1);
+
+}
+
+IndexBatcher::IndexBatcher(std::shared_ptr<DB_Handle> db, std::shared_ptr<IndexWriter> index,
+	size_t batchSize, std::chrono::milliseconds flushInterval, size_t workers, size_t capacity)
+	: db_(std::move(db)), index_(std::move(index)), batchSize_(batchSize > 0 ? batchSize : 1), flushInterval_(flushInterval),
+	queue_(capacity)
+{
+	for (size_t i = 0; i < std::max<size_t>(workers, 1); i++) {
+		workers_.emplace_back(&IndexBatcher::work, this);
+	}
+}
+
+IndexBatcher::~IndexBatcher()
+{
+	flush();
+}
+
+void IndexBatcher::add(PageWords&& page)
+{
+	queue_.push(std::move(page));
+}
+
+void IndexBatcher::flush()
+{
+	if (flushed_) {
+		return;
+	}
+	flushed_ = true;
+
+	queue_.close(); //       
+	for (auto& worker : workers_) {
+		worker.join();
+	}
+	if (index_) {
+		std::vector<PageWords> none;
+		write(none, true); //    ,   flushInterval
+	}
+}
+
+IndexBatcher::Stats IndexBatcher::stats() const
+{
+	Stats stats;
+	stats.queue = queue_.stats();
+	stats.capacity = queue_.capacity();
+	stats.workers = workers_.size();
+	stats.pages = pages_.load(std::memory_order_relaxed);
+	stats.busySeconds = busyMicros_.load(std::memory_order_relaxed) / 1e6;
+	stats.retries = retries_.load(std::memory_order_relaxed);
+	stats.failedBatches = failedBatches_.load(std::memory_order_relaxed);
+	stats.failedPages = failedPages_.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void IndexBatcher::work()
+{
+	std::vector<PageWords> batch;
+	batch.reserve(batchSize_);
+	auto deadline = std::chrono::steady_clock::now() + flushInterval_;
+
+	while (true) {
+		PageWords page;
+		bool got = queue_.popFor(page, deadline - std::chrono::steady_clock::now());
+		if (got) {
+			batch.push_back(std::move(page));
+			if (batch.size() < batchSize_ && std::chrono::steady_clock::now() < deadline) {
+				continue;
+			}
+		}
+		else if (queue_.closed()) {
+			break; //    
+		}
+
+		//     :     
+		if (!batch.empty() || index_) {
+			write(batch, false);
+		}
+		batch.clear();
+		deadline = std::chrono::steady_clock::now() + flushInterval_;
+	}
+
+	if (!batch.empty()) {
+		write(batch, false);
+	}
+}
+
+void IndexBatcher::write(std::vector<PageWords>& batch, bool final)
+{
+	auto started = std::chrono::steady_clock::now();
+	//   :      , 
+	//       
+	for (int attempt = 1; ; attempt++) {
+		try {
+			writeOnce(batch, final);
+			pages_.fetch_add(batch.size(), std::memory_order_relaxed);
+			break;
+		}
+		catch (const std::exception& e) {
+			if (attempt >= writeAttempts) {
+				std::cout << "Index batch of " << batch.size() << " pages dropped after " << attempt
+					<< " attempts: " << e.what() << std::endl;
+				failedBatches_.fetch_add(1, std::memory_order_relaxed);
+				failedPages_.fetch_add(batch.size(), std::memory_order_relaxed);
+				break;
+			}
+			std::cout << "Index batch write failed, retrying: " << e.what() << std::endl;
+			retries_.fetch_add(1, std::memory_order_relaxed);
+			std::this_thread::sleep_for(retryPause * attempt);
+		}
+	}
+
+	busyMicros_.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - started).count(), std::memory_order_relaxed);
+}
+
+void IndexBatcher::writeOnce(std::vector<PageWords>& batch, bool final)
+{
+	//      :     .
+	//      ,        
+	bool changed = std::any_of(batch.begin(), batch.end(), [](const PageWords& page) { return !page.unchanged; });
+	if (!index_) {
+		if (changed) {
+			db_->add_pages(batch); //        
+		}
+	}
+	else {
+		if (changed) {
+			std::vector<int> ids = db_->add_documents(batch);
+			for (size_t i = 0; i < batch.size(); i++) {
+				//    :         
+				if (ids[i] > 0 && !batch[i].unchanged) {
+					index_->add(static_cast<uint32_t>(ids[i]), batch[i].positions);
+				}
+			}
+		}
+
+		//    ,      
+		bool published = final ? index_->flush() : index_->flushIfNeeded();
+		if (published) {
+			db_->bump_crawl_epoch(); //     
+		}
+	}
+	db_->save_page_states(batch);
+}
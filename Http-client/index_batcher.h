@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "bounded_queue.h"
+#include "../DB-service/DB_service.h"
+#include "../Index-service/index_writer.h"
+
+//    :     ,  
+//     ,   batchSize    flushInterval.
+//    add -    .
+//    (index != nullptr)     ,  -   ,
+//   ,   .
+// ,     ( ,    ), 
+//   ;     ,     
+class IndexBatcher {
+public:
+	struct Stats {
+		BoundedQueue<PageWords>::Stats queue;
+		size_t capacity = 0;
+		size_t workers = 0;
+		uint64_t pages = 0;     //  
+		double busySeconds = 0;  //      
+		uint64_t retries = 0;        //    
+		uint64_t failedBatches = 0;  // ,     
+		uint64_t failedPages = 0;
+	};
+
+	IndexBatcher(std::shared_ptr<DB_Handle> db, std::shared_ptr<IndexWriter> index,
+		size_t batchSize, std::chrono::milliseconds flushInterval, size_t workers, size_t capacity);
+	~IndexBatcher();
+
+	void add(PageWords&& page);
+	//      ;  flush add   
+	void flush();
+
+	Stats stats() const;
+
+	IndexBatcher(const IndexBatcher&) = delete;
+	IndexBatcher& operator=(const IndexBatcher&) = delete;
+
+private:
+	std::shared_ptr<DB_Handle> db_;
+	std::shared_ptr<IndexWriter> index_;
+	const size_t batchSize_;
+	const std::chrono::milliseconds flushInterval_;
+
+	BoundedQueue<PageWords> queue_;
+	std::vector<std::thread> workers_;
+	bool flushed_ = false;
+	std::atomic<uint64_t> pages_{0};
+	std::atomic<uint64_t> busyMicros_{0};
+	std::atomic<uint64_t> retries_{0};
+	std::atomic<uint64_t> failedBatches_{0};
+	std::atomic<uint64_t> failedPages_{0};
+
+	void work();
+	void write(std::vector<PageWords>& batch, bool final);
+	void writeOnce(std::vector<PageWords>& batch, bool final);
+};
@@ -1,169 +1,153 @@
 #include <iostream>
 #include <vector>
-#include <thread>
-#include <mutex>
-#include <queue>
-#include <condition_variable>
-#include <functional>
+#include <memory>
+#include <unordered_map>
 
 #include <boost/asio.hpp>
 
 #include "http_utils.h"
-#include "parser.h"
+#include "fetcher.h"
+#include "frontier.h"
+#include "crawler.h"
+#include "index_batcher.h"
 #include "../DB-service/DB_service.h"
 
-template <class T>
-class safe_queue {
-private:
-	std::queue<T> task_list;
-	std::mutex m;
-	std::condition_variable condition;
-	std::atomic<bool> done{ false };
-public:
-	void push(T&& f_obj) {
-		{
-			std::unique_lock<std::mutex> lock(m);
-			task_list.push(f_obj);
-		}
-		condition.notify_one();
-	}
-	void pop() {
-		std::function<void()> task;
-		{
-			std::unique_lock<std::mutex> lock(m);
-			auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(2);
-			if (condition.wait_until(lock, timeout, [this] { return !task_list.empty(); })) {
-				if (!task_list.empty()) {
-					task = std::move(task_list.front());
-					task_list.pop();
-				}
-			}
-			else {
-				if (task_list.empty()) { done = true; }
-			}
-		}
-		if (task) {
-			task(); //  
-		}
-	}
-	void finish() {
-		done = true; //   
-		condition.notify_all(); //   
-	}
-	bool is_done() const {
-		return done;
-	}
-	bool empty() const {
-		return task_list.empty();
-	}
-	~safe_queue() {
-		std::cout << "Destructing safe_queue" << std::endl;
-	}
-};
-
-class thread_pool {
-private:
-	std::vector<std::thread> VT{};
-	safe_queue<std::function<void()>> SQ{};
-	const size_t cores{ std::thread::hardware_concurrency() - 2 };
-	std::atomic<bool> done{ false };
-public:
-	thread_pool() {
-		for (size_t i = 0; i < cores; i++) {
-			VT.push_back(std::thread(&thread_pool::work, this));
-		}
-	}
-	void work() {
-		 while (!SQ.is_done()){
-				SQ.pop();
-		}
-	}
-	void submit(std::function<void()>&& f_obj) {
-		SQ.push(std::move(f_obj));
-	}
-
-	bool task_empty() {
-		return SQ.empty();
-	}
-
-	void finish() {
-		for (auto& thread : VT) {
-			if (thread.joinable()) {
-				thread.join(); //     
-			}
-		}
-	}
+int main()
+{
 
-	~thread_pool() {
-		finish();
-		std::cout << "Destructing thread_pool" << std::endl;
-	}
-};
+	SetConsoleCP(CP_UTF8);
+	SetConsoleOutputCP(CP_UTF8);
 
-void parseLink(thread_pool& pool, const Link& link, int depth, std::shared_ptr<DB_Handle> db)
-{
 	try {
+		Config::getInstance().initialize("../config.ini");
+		const auto& dbSettings = Config::getInstance().getDataBaseSettings();
+		auto currDB = std::make_shared<DB_Handle>(dbSettings); //   ,     ;  -  
 
-		std::string html = getHtmlContent(link, pool, [&](const Link& newLink) {
-			//     
-			pool.submit([&pool, newLink, depth, db]() {
-				parseLink(pool, newLink, depth, db);
-				});
-			});
-
-		if (html.size() == 0)
-		{
-			std::cout << "Failed to get HTML Content for: " << link.hostName << link.query << std::endl;
-			return;
-		}
-
-		std::string linkText = getLinkText(link);
-		int link_id = db->add_link(linkText);
-		int word_id;
+		const auto& spiderSettings = Config::getInstance().getSpiderSettings();
 
-		std::unordered_map<std::string, int> wordsCount;
-		getWords(wordsCount, html);
-		for (const auto& [word, count] : wordsCount) {
-			word_id = db->add_word(word);
-			db->add_frequency(link_id, word_id, count);
+		const auto& indexSettings = Config::getInstance().getIndexSettings();
+		std::shared_ptr<IndexWriter> indexWriter;
+		if (indexSettings.engine == "native") {
+			indexWriter = std::make_shared<IndexWriter>(indexSettings);
 		}
+		else {
+			currDB->preload_words(); //  id     
+		}
+
+		auto index = std::make_shared<IndexBatcher>(currDB, indexWriter, spiderSettings.batchSize,
+			std::chrono::milliseconds(spiderSettings.flushInterval), spiderSettings.indexWorkers, spiderSettings.queueCapacity);
 
-		if (depth > 0) {
+		Fetcher fetcher(spiderSettings);
+		Frontier frontier(spiderSettings.frontierCapacity, spiderSettings.frontierExactLimit);
 
-			std::vector<Link> links = extractLinks(html, link);
+		Link link = Link::parse(spiderSettings.mainLink);
+		std::cout << "working link: " << getLinkText(link) << std::endl;
+		int depth = std::stoi(spiderSettings.depth);
 
-			for (auto& subLink : links) {
-				pool.submit([&pool, subLink, depth, db]() { parseLink(pool, subLink, depth - 1, db); });
+		std::string crawlStarted = currDB->start_crawl();
+		std::vector<int> expired = currDB->expire_page_states();
+		if (!expired.empty()) {
+			if (indexWriter && indexWriter->stats().segments > 0) {
+				//         
+				for (int id : expired) {
+					indexWriter->add(static_cast<uint32_t>(id), {});
+				}
+				if (indexWriter->flush()) {
+					currDB->bump_crawl_epoch();
+				}
 			}
+			std::cout << "forgot " << expired.size() << " pages not reached by the last crawl" << std::endl;
 		}
 
-	}
-	catch (const std::exception& e)
-	{
-		std::cout << e.what() << std::endl;
-	}
-
-}
+		//     ,    ,  
+		//    :         
+		std::unordered_map<std::string, PageState> known;
+		if (spiderSettings.incremental) {
+			std::string previousEngine = currDB->get_index_engine();
+			if (previousEngine != indexSettings.engine) {
+				std::cout << "index engine changed from " << previousEngine << " to " << indexSettings.engine
+					<< ", running a full crawl" << std::endl;
+			}
+			else if (indexWriter && indexWriter->stats().segments == 0) {
+				std::cout << "index at " << indexSettings.path << " is empty, running a full crawl" << std::endl;
+			}
+			else {
+				known = currDB->get_page_states(); //    
+			}
+		}
 
-int main()
-{
+		Crawler crawler(spiderSettings, fetcher, frontier, *index, indexWriter != nullptr, std::move(known));
+		crawler.run(link, depth); // ,       ,   
+
+		fetcher.stop();
+		index->flush();
+		currDB->finish_crawl(crawlStarted, indexSettings.engine);
+		crawler.report();
+
+		auto poolStats = fetcher.pool().stats();
+		std::cout << "connections: reused " << poolStats.hits << ", opened " << poolStats.misses
+			<< ", TLS handshakes " << poolStats.handshakes << " (resumed " << poolStats.resumed << ")"
+			<< ", evicted " << poolStats.evicted << std::endl;
+
+		auto dnsStats = fetcher.dns().stats();
+		uint64_t resolves = dnsStats.hits + dnsStats.coalesced + dnsStats.misses;
+		std::cout << "dns: " << dnsStats.hosts << " hosts, " << resolves << " lookups, "
+			<< (resolves ? (dnsStats.hits + dnsStats.coalesced) * 100.0 / resolves : 100.0) << "% without a resolver call (cached "
+			<< dnsStats.hits << ", coalesced " << dnsStats.coalesced << "), failures " << dnsStats.failures << std::endl;
+
+		uint64_t wireBytes = 0;
+		uint64_t bodyBytes = 0;
+		uint64_t compressedResponses = 0;
+		for (const auto& [host, transfer] : fetcher.transferStats()) {
+			std::cout << "  " << host << ": " << transfer.responses << " responses (" << transfer.compressedResponses
+				<< " compressed), " << transfer.wireBytes / 1024 << " KB received, " << transfer.bodyBytes / 1024
+				<< " KB decoded" << std::endl;
+			wireBytes += transfer.wireBytes;
+			bodyBytes += transfer.bodyBytes;
+			compressedResponses += transfer.compressedResponses;
+		}
+		std::cout << "transfer: " << wireBytes / 1024 << " KB received, " << bodyBytes / 1024 << " KB decoded, "
+			<< compressedResponses << " compressed responses" << std::endl;
+
+		auto hostStats = crawler.scheduler().stats();
+		std::cout << "hosts: " << hostStats.hosts << ", throttled responses " << hostStats.throttled
+			<< " (retried " << hostStats.retried << ", dropped " << hostStats.dropped << ")";
+		if (!hostStats.slowestHost.empty()) {
+			std::cout << ", slowest " << hostStats.slowestHost << " at " << hostStats.slowestDelay.count() << " ms per request";
+		}
+		std::cout << std::endl;
 
-	SetConsoleCP(CP_UTF8);
-	SetConsoleOutputCP(CP_UTF8);
+		auto batchStats = index->stats();
+		std::cout << "index writes: " << batchStats.pages << " pages written, " << batchStats.retries << " retries, "
+			<< batchStats.failedBatches << " batches failed (" << batchStats.failedPages << " pages lost)" << std::endl;
 
-	try {
-		thread_pool test;
+		if (indexWriter) {
+			auto indexStats = indexWriter->stats();
+			std::cout << "index: " << indexStats.segments << " segments (" << indexStats.bytes / 1024 << " KB), "
+				<< indexStats.flushes << " flushes, " << indexStats.merges << " merges (" << indexStats.failedMerges
+				<< " failed)" << std::endl;
+		}
+		else {
+			auto wordStats = currDB->word_cache_stats();
+			uint64_t lookups = wordStats.hits + wordStats.misses;
+			std::cout << "word ids: " << wordStats.words << " cached, " << wordStats.hits << " of " << lookups
+				<< " lookups served from memory (" << (lookups ? wordStats.hits * 100.0 / lookups : 100.0) << "%)" << std::endl;
+		}
 
-		Config::getInstance().initialize("../config.ini");
-		const auto& dbSettings = Config::getInstance().getDataBaseSettings();
-		auto currDB = std::make_shared<DB_Handle>(dbSettings); //   ,     
+		auto recrawlStats = crawler.recrawlStats();
+		std::cout << "recrawl: " << recrawlStats.known << " known pages, " << recrawlStats.notModified << " not modified, "
+			<< recrawlStats.unchanged << " unchanged bodies, " << recrawlStats.indexed << " pages indexed" << std::endl;
 
-		const auto& spiderSettings = Config::getInstance().getSpiderSettings();
-		Link link = Link::parse(spiderSettings.mainLink);
-		std::cout << "working link: " << getLinkText(link) << std::endl;
-		int depth = std::stoi(spiderSettings.depth);
+		auto duplicateStats = crawler.duplicateStats();
+		std::cout << "near duplicates: " << duplicateStats.duplicates << " of " << duplicateStats.lookups
+			<< " pages recorded as aliases (" << duplicateStats.pages << " canonical pages, "
+			<< duplicateStats.candidates << " candidates compared)" << std::endl;
 
-		test.submit([&test, link, depth, currDB]() { parseLink(test, link, depth, currDB); });
+		auto frontierStats = frontier.stats();
+		std::cout << "links: submitted " << frontierStats.submitted << ", crawled " << frontierStats.scheduled
+			<< " (again with more depth " << frontierStats.readmitted << ")"
+			<< ", duplicates skipped " << frontierStats.duplicates << " (bloom hits checked " << frontierStats.bloomChecks
+			<< ", memory " << frontierStats.memory / 1024 << " KB)" << std::endl;
 	}
 	catch (const std::exception& e)
 	{
@@ -1,29 +1,46 @@
 #include "parser.h"
 
 #include <iostream>
-#include <boost/locale.hpp>
-#include <boost/regex.hpp>
+
+#include "html_tokenizer.h"
+#include "http_utils.h"
+#include "../Text-service/text_utils.h"
 
 void getWords(std::unordered_map<std::string, int>& wordsCount, const std::string& html)
 {
-	try {
-		//  HTML-
-		std::string text = boost::regex_replace(html, boost::regex(R"(<[^>]+>)"), " ");
-
-		//     
-		text = boost::locale::to_lower(text, boost::locale::generator().generate(""));
-
-		//      ( )
-		boost::regex expression(R"(\b[a-zA-Z]+\b)");
+	parsePage(html, Link{}, wordsCount, nullptr);
+}
 
-		boost::sregex_iterator it(text.begin(), text.end(), expression);
-		boost::sregex_iterator end;
+void parsePage(const std::string& html, const Link& currLink,
+	std::unordered_map<std::string, int>& wordsCount, std::vector<Link>* links,
+	std::unordered_map<std::string, std::vector<uint32_t>>* positions)
+{
+	try {
+		WordSplitter splitter;
+		std::string key;
+		uint32_t position = 0; //       
 
-		while (it != end) {
-			std::string word = it->str();
-			wordsCount[word]++;
-			++it;
-		}
+		//         
+		HtmlTokenizer tokenizer(
+			[&](std::string_view text) {
+				splitter.split(text, [&](std::string_view word) {
+					key.assign(word.data(), word.size());
+					if (positions) {
+						(*positions)[key].push_back(position++);
+					}
+					else {
+						wordsCount[key]++;
+					}
+					});
+			},
+			[&](std::string_view href) {
+				Link link;
+				if (links && linkFromHref(std::string(href), currLink, link)) {
+					links->push_back(std::move(link));
+				}
+			});
+		tokenizer.feed(html);
+		tokenizer.finish();
 	}
 	catch (const std::exception& e) {
 		std::cout << e.what() << std::endl;
@@ -1,6 +1,14 @@
 #pragma once
 
+#include <vector>
 #include <unordered_map>
 #include <boost/beast/http.hpp>
+#include "link.h"
 
-void getWords(std::unordered_map<std::string, int>& wordsCount, const std::string& html);
\ No newline at end of file
+void getWords(std::unordered_map<std::string, int>& wordsCount, const std::string& html);
+
+//  :    ( links  nullptr)  .
+//  positions  nullptr,        
+void parsePage(const std::string& html, const Link& currLink,
+	std::unordered_map<std::string, int>& wordsCount, std::vector<Link>* links,
+	std::unordered_map<std::string, std::vector<uint32_t>>* positions = nullptr);
@@ -0,0 +1,232 @@
+//     :    (  std::function
+//  ,   2  ,    )
+//     (BoundedQueue       ).
+//    :  ""       .
+//   PoolBench [] [] [] [ ]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <memory>
+
+#include "bounded_queue.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Workload {
+	size_t fanout = 8;
+	int depth = 5;
+	size_t bodyBytes = 16 * 1024;
+};
+
+// "" :   ,    
+uint64_t digest(const std::string& body)
+{
+	uint64_t h = 14695981039346656037ull;
+	for (unsigned char c : body) {
+		h ^= c;
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+size_t taskCount(const Workload& load)
+{
+	size_t total = 0;
+	size_t level = 1;
+	for (int i = 0; i <= load.depth; i++) {
+		total += level;
+		level *= load.fanout;
+	}
+	return total;
+}
+
+//    main.cpp    
+class LegacyPool {
+public:
+	explicit LegacyPool(size_t workers)
+	{
+		for (size_t i = 0; i < workers; i++) {
+			threads_.emplace_back(&LegacyPool::work, this);
+		}
+	}
+
+	void submit(std::function<void()>&& task)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_);
+			tasks_.push(task); // ,   safe_queue::push
+		}
+		condition_.notify_one();
+	}
+
+	void join()
+	{
+		for (auto& thread : threads_) {
+			thread.join();
+		}
+	}
+
+private:
+	std::vector<std::thread> threads_;
+	std::queue<std::function<void()>> tasks_;
+	std::mutex m_;
+	std::condition_variable condition_;
+	std::atomic<bool> done_{false};
+
+	void work()
+	{
+		while (!done_) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_);
+				auto timeout = Clock::now() + std::chrono::seconds(2);
+				if (condition_.wait_until(lock, timeout, [this] { return !tasks_.empty(); })) {
+					task = std::move(tasks_.front());
+					tasks_.pop();
+				}
+				else {
+					done_ = true;
+				}
+			}
+			if (task) {
+				task();
+			}
+		}
+	}
+};
+
+struct Result {
+	double lastTask = 0;  //   
+	double exit = 0;      //  ,    
+	uint64_t checksum = 0;
+};
+
+Result runLegacy(size_t workers, const Workload& load)
+{
+	Result result;
+	std::atomic<uint64_t> checksum{0};
+	std::atomic<int64_t> lastDone{0};
+	auto started = Clock::now();
+
+	LegacyPool pool(workers);
+	std::function<void(std::string, int)> page = [&](std::string body, int depth) {
+		checksum += digest(body);
+		if (depth < load.depth) {
+			for (size_t i = 0; i < load.fanout; i++) {
+				std::string child(load.bodyBytes, static_cast<char>('a' + (depth + i) % 26));
+				pool.submit([&page, child, depth] { page(child, depth + 1); });
+			}
+		}
+		lastDone = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count();
+	};
+	std::string root(load.bodyBytes, 'a');
+	pool.submit([&page, root] { page(root, 0); });
+	pool.join();
+
+	result.exit = std::chrono::duration<double>(Clock::now() - started).count();
+	result.lastTask = lastDone / 1e6;
+	result.checksum = checksum;
+	return result;
+}
+
+//  :    ,   -  
+//    ,  Crawler::active_
+Result runStage(size_t workers, const Workload& load)
+{
+	struct Page {
+		std::string body;
+		int depth = 0;
+	};
+
+	Result result;
+	std::atomic<uint64_t> checksum{0};
+	std::atomic<size_t> active{0};
+	auto started = Clock::now();
+	Clock::time_point lastDone;
+
+	BoundedQueue<Page> queue(taskCount(load)); //         
+	auto finish = [&] {
+		if (active.fetch_sub(1) == 1) {
+			lastDone = Clock::now();
+			queue.close();
+		}
+	};
+	auto worker = [&] {
+		Page page;
+		while (queue.pop(page)) {
+			checksum += digest(page.body);
+			if (page.depth < load.depth) {
+				for (size_t i = 0; i < load.fanout; i++) {
+					active++;
+					queue.push({std::string(load.bodyBytes, static_cast<char>('a' + (page.depth + i) % 26)), page.depth + 1});
+				}
+			}
+			finish();
+		}
+	};
+
+	active++;
+	queue.push({std::string(load.bodyBytes, 'a'), 0});
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < workers; i++) {
+		threads.emplace_back(worker);
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	result.exit = std::chrono::duration<double>(Clock::now() - started).count();
+	result.lastTask = std::chrono::duration<double>(lastDone - started).count();
+	result.checksum = checksum;
+	return result;
+}
+
+void print(const char* name, const Result& result, size_t tasks)
+{
+	std::cout << std::left << std::setw(8) << name << std::right
+		<< " work " << std::setw(8) << result.lastTask * 1000 << " ms ("
+		<< std::setw(10) << tasks / result.lastTask << " tasks/s), finished after "
+		<< result.exit * 1000 << " ms" << std::endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	size_t workers = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+	Workload load;
+	if (argc > 2) {
+		load.fanout = std::stoul(argv[2]);
+	}
+	if (argc > 3) {
+		load.depth = std::stoi(argv[3]);
+	}
+	if (argc > 4) {
+		load.bodyBytes = std::stoul(argv[4]);
+	}
+
+	size_t tasks = taskCount(load);
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << workers << " workers, " << tasks << " tasks, " << load.bodyBytes << " bytes per page" << std::endl;
+
+	Result legacy = runLegacy(workers, load);
+	Result stage = runStage(workers, load);
+	print("legacy", legacy, tasks);
+	print("stage", stage, tasks);
+	if (legacy.checksum != stage.checksum) {
+		std::cout << "checksum mismatch" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -6,41 +6,33 @@
 #include <codecvt>
 #include <iostream>
 
-#include <boost/locale.hpp>
-#include <boost/regex.hpp>
+#include "query_parser.h"
 
 namespace beast = boost::beast;
 namespace http = beast::http;
 namespace net = boost::asio;
 using tcp = boost::asio::ip::tcp;
 
-std::vector<std::string> splitString(const std::string& str, char delimiter) {
-
-	if (str.empty()) {
-		throw std::runtime_error("Empty search attempt!");
-	}
-
-	std::vector<std::string> result;
-	std::stringstream ss(str);
-	std::string item;
-
-	while (std::getline(ss, item, delimiter)) {
-		result.push_back(item);
-	}
-
-	return result;
-}
-
 std::string url_decode(const std::string& encoded) {
 	std::string res;
-	std::istringstream iss(encoded);
-	char ch;
-
-	while (iss.get(ch)) {
-		if (ch == '%') {
-			int hex;
-			iss >> std::hex >> hex;
-			res += static_cast<char>(hex);
+	res.reserve(encoded.size());
+
+	auto hex = [](char c) -> int {
+		if (c >= '0' && c <= '9') return c - '0';
+		if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	};
+
+	// %XX -     ( UTF-8  ), '+' - 
+	for (size_t i = 0; i < encoded.size(); i++) {
+		char ch = encoded[i];
+		if (ch == '%' && i + 2 < encoded.size() && hex(encoded[i + 1]) >= 0 && hex(encoded[i + 2]) >= 0) {
+			res += static_cast<char>(hex(encoded[i + 1]) * 16 + hex(encoded[i + 2]));
+			i += 2;
+		}
+		else if (ch == '+') {
+			res += ' ';
 		}
 		else {
 			res += ch;
@@ -50,21 +42,13 @@ std::string url_decode(const std::string& encoded) {
 	return res;
 }
 
-std::string convert_to_utf8_lower(const std::string& str) {
-	std::string url_decoded = boost::locale::to_lower(url_decode(str), boost::locale::generator().generate(""));
-	return url_decoded;
-}
-
-HttpConnection::HttpConnection(tcp::socket socket, const Config::DataBase& db)
-	: socket_(std::move(socket)), database_({db})
+HttpConnection::HttpConnection(tcp::socket socket, std::shared_ptr<QueryExecutor> queries, const Config::Server& settings)
+	: socket_(std::move(socket)), queries_(std::move(queries)),
+	requestTimeout_(settings.requestTimeout),
+	maxRequests_(settings.maxRequestsPerConnection > 0 ? settings.maxRequestsPerConnection : 1)
 {
 }
 
-//HttpConnection::HttpConnection(tcp::socket socket, std::shared_ptr<DB_Handle> db)
-//	: socket_(std::move(socket)), database_(std::move(db))
-//{
-//}
-
 //HttpConnection::HttpConnection(tcp::socket socket)
 //	: socket_(std::move(socket))
 //{
@@ -74,7 +58,6 @@ HttpConnection::HttpConnection(tcp::socket socket, const Config::DataBase& db)
 void HttpConnection::start()
 {
 	readRequest();
-	checkDeadline();
 }
 
 
@@ -82,6 +65,9 @@ void HttpConnection::readRequest()
 {
 	auto self = shared_from_this();
 
+	request_ = {};
+	resetDeadline(); //      ,    
+
 	http::async_read(
 		socket_,
 		buffer_,
@@ -92,13 +78,20 @@ void HttpConnection::readRequest()
 			boost::ignore_unused(bytes_transferred);
 			if (!ec)
 				self->processRequest();
+			else
+				self->deadline_.cancel(); //       
 		});
 }
 
 void HttpConnection::processRequest()
 {
+	requests_++;
+
+	//   :    ,   
+	response_.clear();
+	response_.body().clear();
 	response_.version(request_.version());
-	response_.keep_alive(false);
+	response_.keep_alive(request_.keep_alive() && requests_ < maxRequests_);
 
 	switch (request_.method())
 	{
@@ -111,7 +104,7 @@ void HttpConnection::processRequest()
 		response_.result(http::status::ok);
 		response_.set(http::field::server, "Beast");
 		createResponsePost();
-		break;
+		return; //     
 
 	default:
 		response_.result(http::status::bad_request);
@@ -147,23 +140,26 @@ void HttpConnection::createResponseGet()
 				<< "</body>\n"
 				<< "</html>\n";
 		}
+		else if (request_.target() == "/stats")
+		{
+			auto stats = queries_->cache().stats();
+			response_.set(http::field::content_type, "text/plain");
+			beast::ostream(response_.body())
+				<< "cache hits: " << stats.hits << "\n"
+				<< "cache misses: " << stats.misses << "\n"
+				<< "cache evictions: " << stats.evictions << "\n"
+				<< "cache invalidations: " << stats.invalidations << "\n"
+				<< "cache entries: " << stats.entries << "\n"
+				<< "cache bytes: " << stats.bytes << "\n"
+				<< "crawl epoch: " << queries_->cache().epoch() << "\n";
+		}
 		else
 		{
 			throw std::runtime_error("File not found");
 		}
 	}
 	catch (const std::exception& e) {
-		response_.result(http::status::internal_server_error);
-		response_.set(http::field::content_type, "text/html");
-		beast::ostream(response_.body())
-			<< "<html>\n"
-			<< "<head><meta charset=\"UTF-8\"><title>Error</title></head>\n"
-			<< "<body>\n"
-			<< "<h1>Error</h1>\n"
-			<< "<p>" << e.what() << "</p>\n"
-			<< "<a href=\"/\">Back to Search</a>\n" 
-			<< "</body>\n"
-			<< "</html>\n";
+		createResponseError(e.what());
 	}
 
 }
@@ -184,44 +180,13 @@ void HttpConnection::createResponsePost()
 
 			std::string key = s.substr(0, pos);
 			std::string value = s.substr(pos + 1);
-			std::string utf8value = convert_to_utf8_lower(value);
 
 			if (key != "search")
 			{
 				throw std::runtime_error("Invalid search key");
 			}
 
-			utf8value = boost::regex_replace(utf8value, boost::regex(R"([^a-zA-Z\+])"), "");
-			std::vector<std::string> words = splitString(utf8value, '+');
-			std::vector<std::string> searchResult = database_.get_query_result(words);
-
-			response_.set(http::field::content_type, "text/html");
-			beast::ostream(response_.body())
-				<< "<html>\n"
-				<< "<head><meta charset=\"UTF-8\"><title>Search Engine</title></head>\n"
-				<< "<body>\n"
-				<< "<h1>Search Engine</h1>\n"
-				<< "<p>Response:<p>\n"
-				<< "<ul>\n";
-
-			if (searchResult.empty()) {
-				beast::ostream(response_.body())
-					<< "<p>Could not find pages with this content!<p>\n";
-			}
-			else {
-				for (const auto& url : searchResult) {
-					beast::ostream(response_.body())
-						<< "<li><a href=\"" << url << "\">" << url << "</a></li>";
-				}
-			}
-
-			beast::ostream(response_.body())
-				<< "</ul>\n"
-				<< "<form onsubmit=\"return false;\">\n"
-				<< "<button type=\"button\" onclick=\"window.location.href='/'\">Back to Search</button>\n"
-				<< "</form>\n"
-				<< "</body>\n"
-				<< "</html>\n";
+			startSearch(parseQuery(url_decode(value)));
 		}
 		else
 		{
@@ -230,6 +195,102 @@ void HttpConnection::createResponsePost()
 
 	}
 	catch (const std::exception& e) {
+		createResponseError(e.what());
+		writeResponse();
+	}
+}
+
+void HttpConnection::startSearch(QueryNode query)
+{
+	auto self = shared_from_this();
+
+	cancel_ = std::make_shared<QueryCancel>();
+	watchDisconnect();
+
+	queries_->search(std::move(query), cancel_, socket_.get_executor(),
+		[self](std::exception_ptr error, std::vector<std::string> searchResult)
+		{
+			beast::error_code ec;
+			self->socket_.cancel(ec); //    
+			self->cancel_.reset();
+
+			try {
+				if (error) {
+					std::rethrow_exception(error);
+				}
+				self->createResponseSearch(searchResult);
+			}
+			catch (const std::exception& e) {
+				self->createResponseError(e.what());
+			}
+			self->writeResponse();
+		});
+}
+
+//   ,          
+// ,  :  ,    .     
+// ,   .     buffer_,   
+//   ,    
+void HttpConnection::watchDisconnect()
+{
+	auto self = shared_from_this();
+
+	socket_.async_wait(tcp::socket::wait_read,
+		[self](beast::error_code ec)
+		{
+			if (ec || !self->cancel_) {
+				return;
+			}
+			size_t room = self->buffer_.max_size() - self->buffer_.size();
+			if (room == 0) {
+				return; //   :    
+			}
+			size_t bytes = self->socket_.read_some(self->buffer_.prepare(std::min<size_t>(room, 4096)), ec);
+			if (ec == net::error::eof) {
+				return; //   ,    
+			}
+			if (ec) {
+				self->cancel_->cancel();
+				return;
+			}
+			self->buffer_.commit(bytes);
+			self->watchDisconnect();
+		});
+}
+
+void HttpConnection::createResponseSearch(const std::vector<std::string>& searchResult)
+{
+	response_.set(http::field::content_type, "text/html");
+	beast::ostream(response_.body())
+		<< "<html>\n"
+		<< "<head><meta charset=\"UTF-8\"><title>Search Engine</title></head>\n"
+		<< "<body>\n"
+		<< "<h1>Search Engine</h1>\n"
+		<< "<p>Response:<p>\n"
+		<< "<ul>\n";
+
+	if (searchResult.empty()) {
+		beast::ostream(response_.body())
+			<< "<p>Could not find pages with this content!<p>\n";
+	}
+	else {
+		for (const auto& url : searchResult) {
+			beast::ostream(response_.body())
+				<< "<li><a href=\"" << url << "\">" << url << "</a></li>";
+		}
+	}
+
+	beast::ostream(response_.body())
+		<< "</ul>\n"
+		<< "<form onsubmit=\"return false;\">\n"
+		<< "<button type=\"button\" onclick=\"window.location.href='/'\">Back to Search</button>\n"
+		<< "</form>\n"
+		<< "</body>\n"
+		<< "</html>\n";
+}
+
+void HttpConnection::createResponseError(const std::string& message)
+{
 	response_.result(http::status::internal_server_error);
 	response_.set(http::field::content_type, "text/html");
 	beast::ostream(response_.body())
@@ -237,11 +298,10 @@ void HttpConnection::createResponsePost()
 		<< "<head><meta charset=\"UTF-8\"><title>Error</title></head>\n"
 		<< "<body>\n"
 		<< "<h1>Error</h1>\n"
-		<< "<p>" << e.what() << "</p>\n" 
-		<< "<a href=\"/\">Back to Search</a>\n" 
+		<< "<p>" << message << "</p>\n"
+		<< "<a href=\"/\">Back to Search</a>\n"
 		<< "</body>\n"
 		<< "</html>\n";
-	}
 }
 
 
@@ -256,11 +316,21 @@ void HttpConnection::writeResponse()
 		response_,
 		[self](beast::error_code ec, std::size_t)
 		{
+			// ,  ,    buffer_    
+			if (!ec && self->response_.keep_alive()) {
+				return self->readRequest();
+			}
 			self->socket_.shutdown(tcp::socket::shutdown_send, ec);
 			self->deadline_.cancel();
 		});
 }
 
+void HttpConnection::resetDeadline()
+{
+	deadline_.expires_after(requestTimeout_); //     operation_aborted
+	checkDeadline();
+}
+
 void HttpConnection::checkDeadline()
 {
 	auto self = shared_from_this();
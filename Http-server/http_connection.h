@@ -5,7 +5,8 @@
 #include <boost/beast/version.hpp>
 #include <boost/asio.hpp>
 
-#include "../DB-service/DB_service.h"
+#include "query_executor.h"
+#include "../Config/config.h"
 
 namespace beast = boost::beast;
 namespace http = beast::http;
@@ -18,16 +19,21 @@ protected:
 
 	tcp::socket socket_;
 
-	beast::flat_buffer buffer_{8192};
+	beast::flat_buffer buffer_{8192};  //   :      
 
 	http::request<http::dynamic_body> request_;
 
 	http::response<http::dynamic_body> response_;
 
-	DB_Handle database_;
+	std::shared_ptr<QueryExecutor> queries_;  //    ,      -
 
-	net::steady_timer deadline_{
-		socket_.get_executor(), std::chrono::seconds(60)};
+	std::shared_ptr<QueryCancel> cancel_;  //      
+
+	net::steady_timer deadline_{socket_.get_executor()};
+
+	const std::chrono::seconds requestTimeout_;  //     
+	const size_t maxRequests_;                   //    
+	size_t requests_ = 0;
 
 	void readRequest();
 	void processRequest();
@@ -35,11 +41,16 @@ protected:
 	void createResponseGet();
 
 	void createResponsePost();
+	void startSearch(QueryNode query);
+	void createResponseSearch(const std::vector<std::string>& searchResult);
+	void createResponseError(const std::string& message);
+	void watchDisconnect();
 	void writeResponse();
+	void resetDeadline();
 	void checkDeadline();
 
 public:
-	HttpConnection(tcp::socket socket, const Config::DataBase& db);
+	HttpConnection(tcp::socket socket, std::shared_ptr<QueryExecutor> queries, const Config::Server& settings);
 	void start();
 };
 
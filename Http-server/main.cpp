@@ -3,27 +3,58 @@
 #include <ctime>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
 
 #include "http_connection.h"
 #include "../Config/config.h"
+
+#ifdef _WIN32
 #include <Windows.h>
+#endif
+
 
+#ifdef SO_REUSEPORT
+using reuse_port = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
 
-void httpServer(tcp::acceptor& acceptor, tcp::socket& socket, const Config::DataBase& db)
+//     strand:     
+// ,       
+void httpServer(tcp::acceptor& acceptor, net::io_context& ioc, const std::shared_ptr<QueryExecutor>& queries,
+	const Config::Server& settings)
 {
-	acceptor.async_accept(socket,
-		[&](beast::error_code ec)
+	acceptor.async_accept(net::make_strand(ioc),
+		[&](beast::error_code ec, tcp::socket socket)
 		{
 			if (!ec)
-				std::make_shared<HttpConnection>(std::move(socket), db)->start();
-			httpServer(acceptor, socket, db);
+				std::make_shared<HttpConnection>(std::move(socket), queries, settings)->start();
+			httpServer(acceptor, ioc, queries, settings);
 		});
 }
 
+std::unique_ptr<tcp::acceptor> makeAcceptor(net::io_context& ioc, const tcp::endpoint& endpoint, bool reusePort)
+{
+	auto acceptor = std::make_unique<tcp::acceptor>(ioc);
+	acceptor->open(endpoint.protocol());
+	acceptor->set_option(net::socket_base::reuse_address(true));
+#ifdef SO_REUSEPORT
+	if (reusePort) {
+		acceptor->set_option(reuse_port(true)); //      
+	}
+#endif
+	acceptor->bind(endpoint);
+	acceptor->listen(net::socket_base::max_listen_connections);
+	return acceptor;
+}
+
 int main(int argc, char* argv[])
 {
+#ifdef _WIN32
 	SetConsoleCP(CP_UTF8);
 	SetConsoleOutputCP(CP_UTF8);
+#endif
 
 	try
 	{
@@ -36,15 +67,58 @@ int main(int argc, char* argv[])
 		auto const address = net::ip::make_address("0.0.0.0");
 		unsigned short port = stoi(servertSettings.port);
 
-		net::io_context ioc{1};
+		//    :    ,    
+		auto database = std::make_shared<DB_Handle>(dbSettings);
+		//       ,     
+		const auto& indexSettings = Config::getInstance().getIndexSettings();
+		std::shared_ptr<IndexReader> index;
+		if (indexSettings.engine == "native") {
+			index = std::make_shared<IndexReader>(indexSettings);
+		}
+		auto queries = std::make_shared<QueryExecutor>(database, index, dbSettings.poolSize, servertSettings);
+
+		size_t threads = servertSettings.threads;
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+#ifdef SO_REUSEPORT
+		bool sharded = servertSettings.reusePort && threads > 1;
+#else
+		bool sharded = false; //  SO_REUSEPORT     io_context
+#endif
+
+		//        io_context   
+		std::vector<std::unique_ptr<net::io_context>> contexts;
+		std::vector<std::unique_ptr<tcp::acceptor>> acceptors;
+		tcp::endpoint endpoint{address, port};
+
+		if (sharded) {
+			for (size_t i = 0; i < threads; i++) {
+				contexts.push_back(std::make_unique<net::io_context>(1));
+				acceptors.push_back(makeAcceptor(*contexts.back(), endpoint, true));
+			}
+		}
+		else {
+			contexts.push_back(std::make_unique<net::io_context>(static_cast<int>(threads)));
+			acceptors.push_back(makeAcceptor(*contexts.back(), endpoint, false));
+		}
 
-		tcp::acceptor acceptor{ioc, { address, port }};
-		tcp::socket socket{ioc};
-		httpServer(acceptor, socket, dbSettings);
+		for (size_t i = 0; i < acceptors.size(); i++) {
+			httpServer(*acceptors[i], *contexts[i], queries, servertSettings);
+		}
 
-		std::cout << "Open browser and connect to http://localhost:8080 to see the web server operating" << std::endl;
+		std::cout << "Open browser and connect to http://localhost:" << port << " to see the web server operating"
+			<< " (" << threads << (sharded ? " sharded" : " shared") << " threads)" << std::endl;
 
-		ioc.run();
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i < threads; i++) {
+			net::io_context& ioc = *contexts[i % contexts.size()];
+			workers.emplace_back([&ioc] { ioc.run(); });
+		}
+		for (auto& worker : workers) {
+			worker.join();
+		}
 	}
 	catch (std::exception const& e)
 	{
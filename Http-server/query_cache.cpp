@@ -0,0 +1,109 @@
+#include "query_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+//         (   ,  )
+constexpr size_t entryOverhead = 128;
+constexpr size_t stringOverhead = sizeof(std::string);
+
+}
+
+QueryCache::QueryCache(size_t maxBytes, size_t shards)
+	: shardBytes_(maxBytes / (shards > 0 ? shards : 1))
+{
+	if (shards == 0) {
+		shards = 1;
+	}
+	for (size_t i = 0; i < shards; i++) {
+		shards_.push_back(std::make_unique<Shard>());
+	}
+}
+
+//     AND  OR     
+std::string QueryCache::makeKey(const QueryNode& query)
+{
+	return query.canonical();
+}
+
+QueryCache::Shard& QueryCache::shardFor(const std::string& key)
+{
+	return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+}
+
+void QueryCache::erase(Shard& shard, std::list<Entry>::iterator it)
+{
+	shard.bytes -= it->bytes;
+	shard.index.erase(it->key);
+	shard.lru.erase(it);
+}
+
+bool QueryCache::get(const std::string& key, std::vector<std::string>& urls)
+{
+	Shard& shard = shardFor(key);
+	std::lock_guard<std::mutex> lock(shard.m);
+
+	auto found = shard.index.find(key);
+	if (found == shard.index.end()) {
+		misses_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	auto it = found->second;
+	if (it->epoch < epoch()) {
+		erase(shard, it); //    ,    
+		invalidations_.fetch_add(1, std::memory_order_relaxed);
+		misses_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	shard.lru.splice(shard.lru.begin(), shard.lru, it);
+	urls = it->urls;
+	hits_.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+void QueryCache::put(const std::string& key, int64_t epoch, const std::vector<std::string>& urls)
+{
+	size_t bytes = entryOverhead + 2 * key.size();
+	for (const auto& url : urls) {
+		bytes += stringOverhead + url.size();
+	}
+	if (bytes > shardBytes_ || epoch < this->epoch()) {
+		return; //        
+	}
+
+	Shard& shard = shardFor(key);
+	std::lock_guard<std::mutex> lock(shard.m);
+
+	auto found = shard.index.find(key);
+	if (found != shard.index.end()) {
+		erase(shard, found->second);
+	}
+
+	while (!shard.lru.empty() && shard.bytes + bytes > shardBytes_) {
+		erase(shard, std::prev(shard.lru.end()));
+		evictions_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	shard.lru.push_front({key, epoch, urls, bytes});
+	shard.index.emplace(key, shard.lru.begin());
+	shard.bytes += bytes;
+}
+
+QueryCache::Stats QueryCache::stats() const
+{
+	Stats result;
+	result.hits = hits_.load(std::memory_order_relaxed);
+	result.misses = misses_.load(std::memory_order_relaxed);
+	result.evictions = evictions_.load(std::memory_order_relaxed);
+	result.invalidations = invalidations_.load(std::memory_order_relaxed);
+	for (const auto& shard : shards_) {
+		std::lock_guard<std::mutex> lock(shard->m);
+		result.entries += shard->lru.size();
+		result.bytes += shard->bytes;
+	}
+	return result;
+}
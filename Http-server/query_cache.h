@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+#include "../Index-service/query.h"
+
+//   :  -    ,  -  .
+//        LRU-,    maxBytes.
+//    :            
+class QueryCache {
+public:
+	struct Stats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;      //   
+		uint64_t invalidations = 0;  //  -  
+		size_t entries = 0;
+		size_t bytes = 0;
+	};
+
+	QueryCache(size_t maxBytes, size_t shards);
+
+	static std::string makeKey(const QueryNode& query);
+
+	bool get(const std::string& key, std::vector<std::string>& urls);
+	void put(const std::string& key, int64_t epoch, const std::vector<std::string>& urls);
+
+	int64_t epoch() const { return epoch_.load(std::memory_order_acquire); }
+	void setEpoch(int64_t epoch) { epoch_.store(epoch, std::memory_order_release); }
+
+	Stats stats() const;
+
+	QueryCache(const QueryCache&) = delete;
+	QueryCache& operator=(const QueryCache&) = delete;
+
+private:
+	struct Entry {
+		std::string key;
+		int64_t epoch;
+		std::vector<std::string> urls;
+		size_t bytes;
+	};
+
+	struct Shard {
+		mutable std::mutex m;
+		std::list<Entry> lru;  //   -  
+		std::unordered_map<std::string, std::list<Entry>::iterator> index;
+		size_t bytes = 0;
+	};
+
+	const size_t shardBytes_;
+	std::vector<std::unique_ptr<Shard>> shards_;
+	std::atomic<int64_t> epoch_{0};
+
+	std::atomic<uint64_t> hits_{0};
+	std::atomic<uint64_t> misses_{0};
+	std::atomic<uint64_t> evictions_{0};
+	std::atomic<uint64_t> invalidations_{0};
+
+	Shard& shardFor(const std::string& key);
+	static void erase(Shard& shard, std::list<Entry>::iterator it);
+};
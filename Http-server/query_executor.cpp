@@ -0,0 +1,108 @@
+#include "query_executor.h"
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+
+namespace net = boost::asio;
+
+QueryExecutor::QueryExecutor(std::shared_ptr<DB_Handle> database, std::shared_ptr<IndexReader> index,
+	size_t threads, const Config::Server& settings)
+	: database_(std::move(database)), index_(std::move(index)), cache_(settings.cacheSize, settings.cacheShards),
+	pool_(threads > 0 ? threads : 1), epochTimer_(net::make_strand(pool_)),
+	epochPollInterval_(settings.epochPollInterval)
+{
+	net::post(epochTimer_.get_executor(), [this] { pollEpoch(); });
+}
+
+QueryExecutor::~QueryExecutor()
+{
+	net::post(epochTimer_.get_executor(), [this] {
+		stopping_ = true;
+		epochTimer_.cancel();
+		});
+	pool_.join();
+}
+
+void QueryExecutor::pollEpoch()
+{
+	if (stopping_) {
+		return;
+	}
+
+	try {
+		//      :    ,
+		//      ,    
+		int64_t epoch = database_->get_crawl_epoch();
+		if (index_) {
+			index_->refresh(); //        
+		}
+		cache_.setEpoch(epoch);
+	}
+	catch (const std::exception&) {
+		//  :   ,    
+	}
+
+	epochTimer_.expires_after(epochPollInterval_);
+	epochTimer_.async_wait([this](const boost::system::error_code& ec) {
+		if (!ec) {
+			pollEpoch();
+		}
+		});
+}
+
+std::vector<std::string> QueryExecutor::execute(const QueryNode& query, QueryCancel* cancel)
+{
+	if (!index_) {
+		std::vector<std::string> words;
+		if (!query.isDisjunction(&words)) {
+			throw std::runtime_error("AND, NOT and phrase search requires the native index");
+		}
+		return database_->get_query_result(words, cancel);
+	}
+
+	std::vector<int> ids;
+	for (const auto& hit : index_->search(query, 10)) {
+		ids.push_back(static_cast<int>(hit.docId));
+	}
+	if (cancel && cancel->cancelled()) {
+		return {};
+	}
+	return database_->get_urls(ids);
+}
+
+void QueryExecutor::search(QueryNode query, std::shared_ptr<QueryCancel> cancel,
+	net::any_io_executor executor, Handler handler)
+{
+	std::string key = QueryCache::makeKey(query);
+
+	std::vector<std::string> cached;
+	if (cache_.get(key, cached)) {
+		net::post(executor, [handler = std::move(handler), cached = std::move(cached)]() mutable {
+			handler(nullptr, std::move(cached));
+			});
+		return;
+	}
+
+	net::post(pool_, [this, key = std::move(key), query = std::move(query), cancel = std::move(cancel),
+		executor = std::move(executor), handler = std::move(handler)]() mutable {
+			std::exception_ptr error;
+			std::vector<std::string> result;
+			try {
+				//    :      ,   
+				int64_t epoch = cache_.epoch();
+				result = execute(query, cancel.get());
+				//    :     put,
+				//        
+				if (!cancel || !cancel->cancelled()) {
+					cache_.put(key, epoch, result);
+				}
+			}
+			catch (...) {
+				error = std::current_exception(); // ,    
+			}
+
+			net::post(executor, [handler = std::move(handler), error, result = std::move(result)]() mutable {
+				handler(error, std::move(result));
+				});
+		});
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <exception>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "query_cache.h"
+#include "../DB-service/DB_service.h"
+#include "../Index-service/index_reader.h"
+#include "../Config/config.h"
+
+//        ,   Postgres
+//    -.    executor .
+//     ,      .
+//    (index != nullptr)    ,     
+class QueryExecutor {
+public:
+	using Handler = std::function<void(std::exception_ptr, std::vector<std::string>)>;
+
+	QueryExecutor(std::shared_ptr<DB_Handle> database, std::shared_ptr<IndexReader> index,
+		size_t threads, const Config::Server& settings);
+	~QueryExecutor();
+
+	// handler   executor; cancel   ,   .
+	//         OR
+	void search(QueryNode query, std::shared_ptr<QueryCancel> cancel,
+		boost::asio::any_io_executor executor, Handler handler);
+
+	QueryCache& cache() { return cache_; }
+
+	QueryExecutor(const QueryExecutor&) = delete;
+	QueryExecutor& operator=(const QueryExecutor&) = delete;
+
+private:
+	std::shared_ptr<DB_Handle> database_;
+	std::shared_ptr<IndexReader> index_;
+	QueryCache cache_;
+	boost::asio::thread_pool pool_;
+	boost::asio::steady_timer epochTimer_;
+	const std::chrono::milliseconds epochPollInterval_;
+	bool stopping_ = false;
+
+	void pollEpoch();
+	std::vector<std::string> execute(const QueryNode& query, QueryCancel* cancel);
+};
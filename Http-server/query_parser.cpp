@@ -0,0 +1,199 @@
+#include "query_parser.h"
+
+#include <stdexcept>
+
+#include "../Text-service/text_utils.h"
+
+namespace {
+
+constexpr size_t maxWords = 32;  //       
+constexpr int maxDepth = 8;
+
+struct Token {
+	enum class Type { Words, And, Or, Not, Open, Close };
+
+	Type type;
+	std::vector<std::string> words;  //     
+};
+
+class QueryParser {
+public:
+	explicit QueryParser(const std::string& text)
+	{
+		tokenize(text);
+	}
+
+	QueryNode parse()
+	{
+		if (tokens_.empty()) {
+			throw std::runtime_error("Empty search attempt!");
+		}
+		QueryNode query = parseOr(0);
+		if (pos_ != tokens_.size()) {
+			throw std::runtime_error("Unexpected ')' in query");
+		}
+		return query;
+	}
+
+private:
+	std::vector<Token> tokens_;
+	size_t pos_ = 0;
+	size_t wordCount_ = 0;
+	WordSplitter splitter_;
+
+	void tokenize(const std::string& text)
+	{
+		size_t i = 0;
+		while (i < text.size()) {
+			char ch = text[i];
+			if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+				i++;
+			}
+			else if (ch == '(' || ch == ')') {
+				tokens_.push_back({ch == '(' ? Token::Type::Open : Token::Type::Close, {}});
+				i++;
+			}
+			else if (ch == '"') {
+				size_t end = text.find('"', i + 1);
+				if (end == std::string::npos) {
+					end = text.size();
+				}
+				addWords(std::string_view(text).substr(i + 1, end - i - 1));
+				i = end + 1;
+			}
+			else {
+				size_t end = text.find_first_of(" \t\r\n()\"", i);
+				if (end == std::string::npos) {
+					end = text.size();
+				}
+				std::string_view word = std::string_view(text).substr(i, end - i);
+				if (word == "AND") {
+					tokens_.push_back({Token::Type::And, {}});
+				}
+				else if (word == "OR") {
+					tokens_.push_back({Token::Type::Or, {}});
+				}
+				else if (word == "NOT") {
+					tokens_.push_back({Token::Type::Not, {}});
+				}
+				else {
+					addWords(word); // "e-mail"     ,    
+				}
+				i = end;
+			}
+		}
+	}
+
+	//    ()  ,    
+	void addWords(std::string_view text)
+	{
+		Token token{Token::Type::Words, {}};
+		splitter_.split(text, [&](std::string_view word) {
+			token.words.emplace_back(word);
+			});
+		if (token.words.empty()) {
+			return;
+		}
+		wordCount_ += token.words.size();
+		if (wordCount_ > maxWords) {
+			throw std::runtime_error("Search query is too long");
+		}
+		tokens_.push_back(std::move(token));
+	}
+
+	bool accept(Token::Type type)
+	{
+		if (pos_ < tokens_.size() && tokens_[pos_].type == type) {
+			pos_++;
+			return true;
+		}
+		return false;
+	}
+
+	//       ,    
+	static QueryNode combine(QueryNode::Type type, std::vector<QueryNode> operands)
+	{
+		if (operands.size() == 1) {
+			return std::move(operands.front());
+		}
+		QueryNode node;
+		node.type = type;
+		for (auto& operand : operands) {
+			if (operand.type == type) {
+				for (auto& child : operand.children) {
+					node.children.push_back(std::move(child));
+				}
+			}
+			else {
+				node.children.push_back(std::move(operand));
+			}
+		}
+		return node;
+	}
+
+	QueryNode parseOr(int depth)
+	{
+		if (depth > maxDepth) {
+			throw std::runtime_error("Search query is nested too deeply");
+		}
+		std::vector<QueryNode> operands;
+		operands.push_back(parseAnd(depth));
+		while (pos_ < tokens_.size() && tokens_[pos_].type != Token::Type::Close) {
+			accept(Token::Type::Or); //     -  OR
+			operands.push_back(parseAnd(depth));
+		}
+		return combine(QueryNode::Type::Or, std::move(operands));
+	}
+
+	QueryNode parseAnd(int depth)
+	{
+		std::vector<QueryNode> operands;
+		operands.push_back(parsePrimary(depth));
+		while (true) {
+			bool conjunction = accept(Token::Type::And);
+			bool negation = accept(Token::Type::Not);
+			if (!conjunction && !negation) {
+				break;
+			}
+			if (!negation) {
+				operands.push_back(parsePrimary(depth));
+				continue;
+			}
+			QueryNode excluded;
+			excluded.type = QueryNode::Type::Not;
+			excluded.children.push_back(parsePrimary(depth));
+			operands.push_back(std::move(excluded));
+		}
+		return combine(QueryNode::Type::And, std::move(operands));
+	}
+
+	QueryNode parsePrimary(int depth)
+	{
+		if (pos_ == tokens_.size()) {
+			throw std::runtime_error("Search query ends with an operator");
+		}
+		Token& token = tokens_[pos_++];
+		if (token.type == Token::Type::Open) {
+			QueryNode node = parseOr(depth + 1);
+			if (!accept(Token::Type::Close)) {
+				throw std::runtime_error("Missing ')' in query");
+			}
+			return node;
+		}
+		if (token.type != Token::Type::Words) {
+			throw std::runtime_error("Expected a word in query");
+		}
+
+		QueryNode node;
+		node.type = token.words.size() == 1 ? QueryNode::Type::Term : QueryNode::Type::Phrase;
+		node.words = std::move(token.words);
+		return node;
+	}
+};
+
+}
+
+QueryNode parseQuery(const std::string& text)
+{
+	return QueryParser(text).parse();
+}
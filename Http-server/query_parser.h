@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+#include "../Index-service/query.h"
+
+//   ,    :
+//      -    (OR), a AND b -  , a NOT b - a  b,
+//   "a b" - ,  ; AND  NOT   OR.
+//    :          .
+//   - std::runtime_error
+QueryNode parseQuery(const std::string& text);
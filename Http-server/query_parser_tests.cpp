@@ -0,0 +1,106 @@
+//    :   (  )
+//    .
+//   QueryParserTests
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+#include "query_parser.h"
+
+namespace {
+
+int failures = 0;
+
+void expectQuery(const std::string& text, const std::string& canonical)
+{
+	try {
+		std::string actual = parseQuery(text).canonical();
+		if (actual != canonical) {
+			std::cout << "FAILED: '" << text << "' parsed as " << actual << " instead of " << canonical << std::endl;
+			failures++;
+		}
+	}
+	catch (const std::exception& e) {
+		std::cout << "FAILED: '" << text << "' rejected: " << e.what() << std::endl;
+		failures++;
+	}
+}
+
+void expectError(const std::string& text, const std::string& message)
+{
+	try {
+		std::string actual = parseQuery(text).canonical();
+		std::cout << "FAILED: '" << text << "' parsed as " << actual << " instead of error '" << message << "'" << std::endl;
+		failures++;
+	}
+	catch (const std::runtime_error& e) {
+		if (e.what() != message) {
+			std::cout << "FAILED: '" << text << "' rejected with '" << e.what() << "' instead of '" << message << "'" << std::endl;
+			failures++;
+		}
+	}
+}
+
+}
+
+int main()
+{
+	const std::vector<std::pair<std::string, std::string>> queries = {
+		{"Apple", "apple"},
+		{"apple banana", "(OR apple banana)"},
+		{"apple OR banana", "(OR apple banana)"},
+		{"apple AND banana", "(AND apple banana)"},
+		// AND  NOT   OR
+		{"apple AND banana OR cherry", "(OR (AND apple banana) cherry)"},
+		{"apple OR banana AND cherry", "(OR (AND banana cherry) apple)"},
+		{"apple banana AND cherry", "(OR (AND banana cherry) apple)"},
+		{"apple NOT banana cherry", "(OR (AND NOT banana apple) cherry)"},
+		{"apple AND NOT banana", "(AND NOT banana apple)"},
+		{"apple AND banana NOT cherry", "(AND NOT cherry apple banana)"},
+		//  ,        
+		{"(apple OR banana) AND cherry", "(AND (OR apple banana) cherry)"},
+		{"apple AND (banana AND cherry)", "(AND apple banana cherry)"},
+		{"((apple))", "apple"},
+		{"apple NOT (banana OR cherry)", "(AND NOT (OR banana cherry) apple)"},
+		//   ,      
+		{"\"Hello World\" apple", "(OR \"hello world\" apple)"},
+		{"\"hello\"", "hello"},
+		{"e-mail", "\"e mail\""},
+		{"apple 2024", "apple"},
+		//   ,   
+		{"apple and banana", "(OR and apple banana)"},
+	};
+	for (const auto& query : queries) {
+		expectQuery(query.first, query.second);
+	}
+
+	expectError("", "Empty search attempt!");
+	expectError("   ", "Empty search attempt!");
+	expectError("2024", "Empty search attempt!");
+	expectError("apple)", "Unexpected ')' in query");
+	expectError("apple AND", "Search query ends with an operator");
+	expectError("apple OR", "Search query ends with an operator");
+	expectError("apple NOT", "Search query ends with an operator");
+	expectError("(apple", "Missing ')' in query");
+	expectError("NOT apple", "Expected a word in query");
+	expectError("apple AND OR banana", "Expected a word in query");
+	expectError("()", "Expected a word in query");
+
+	std::string longQuery;
+	for (int i = 0; i < 33; i++) {
+		longQuery += "word ";
+	}
+	expectError(longQuery, "Search query is too long");
+	expectError(std::string(9, '(') + "apple" + std::string(9, ')'), "Search query is nested too deeply");
+	expectQuery(std::string(8, '(') + "apple" + std::string(8, ')'), "apple");
+
+	if (failures) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,455 @@
+#include "index_reader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <iostream>
+
+#include "posting_lists.h"
+
+namespace {
+
+//  ,        ,  
+//   ;        
+constexpr size_t decodeRatio = 8;
+
+bool betterHit(const SearchHit& a, const SearchHit& b)
+{
+	return a.score != b.score ? a.score > b.score : a.docId < b.docId;
+}
+
+//     
+std::vector<uint32_t> termDocs(const Segment& segment, const index_format::TermEntry& entry)
+{
+	std::vector<uint32_t> docs;
+	docs.reserve(entry.docFreq);
+	for (auto cursor = segment.postings(entry); cursor.valid(); cursor.next()) {
+		docs.push_back(cursor.doc());
+	}
+	return docs;
+}
+
+//   docs ,   (keep)     (!keep)
+void filterByTerm(std::vector<uint32_t>& docs, const Segment& segment, const index_format::TermEntry& entry, bool keep)
+{
+	if (entry.docFreq <= docs.size() * decodeRatio) {
+		std::vector<uint32_t> list = termDocs(segment, entry);
+		if (keep) {
+			posting_lists::intersect(docs, list, docs);
+		}
+		else {
+			posting_lists::subtract(docs, list, docs);
+		}
+		return;
+	}
+
+	size_t count = 0;
+	auto cursor = segment.postings(entry);
+	for (uint32_t doc : docs) {
+		cursor.advance(doc);
+		bool found = cursor.valid() && cursor.doc() == doc;
+		if (found == keep) {
+			docs[count++] = doc;
+		}
+	}
+	docs.resize(count);
+}
+
+// ,        lists.     :
+//      ,     
+std::vector<uint32_t> matchAll(const Segment& segment, const std::vector<std::string>& terms,
+	std::vector<std::vector<uint32_t>> lists)
+{
+	std::vector<const index_format::TermEntry*> entries;
+	for (const auto& term : terms) {
+		const auto* entry = segment.find(term);
+		if (!entry) {
+			return {};
+		}
+		entries.push_back(entry);
+	}
+	std::sort(entries.begin(), entries.end(), [](const index_format::TermEntry* a, const index_format::TermEntry* b) {
+		return a->docFreq < b->docFreq;
+		});
+	std::sort(lists.begin(), lists.end(), [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+		return a.size() < b.size();
+		});
+
+	std::vector<uint32_t> docs;
+	size_t t = 0;
+	size_t l = 0;
+	if (!entries.empty() && (lists.empty() || entries[0]->docFreq <= lists[0].size())) {
+		docs = termDocs(segment, *entries[t++]);
+	}
+	else if (!lists.empty()) {
+		docs = std::move(lists[l++]);
+	}
+
+	for (; l < lists.size() && !docs.empty(); l++) {
+		posting_lists::intersect(docs, lists[l], docs);
+	}
+	for (; t < entries.size() && !docs.empty(); t++) {
+		filterByTerm(docs, segment, *entries[t], true);
+	}
+	return docs;
+}
+
+// ,     :  ,    
+std::vector<uint32_t> matchPhrase(const Segment& segment, const std::vector<std::string>& words)
+{
+	std::vector<uint32_t> docs = matchAll(segment, words, {});
+	if (docs.empty()) {
+		return docs;
+	}
+
+	std::vector<PostingCursor> cursors;
+	for (const auto& word : words) {
+		cursors.push_back(segment.postings(*segment.find(word)));
+	}
+	std::vector<std::vector<uint32_t>> positions(words.size());
+
+	size_t count = 0;
+	for (uint32_t doc : docs) {
+		for (size_t i = 0; i < cursors.size(); i++) {
+			cursors[i].advance(doc);
+			cursors[i].positions(positions[i]);
+		}
+		bool found = false;
+		for (uint32_t first : positions[0]) {
+			found = true;
+			for (size_t i = 1; i < positions.size() && found; i++) {
+				found = std::binary_search(positions[i].begin(), positions[i].end(), first + static_cast<uint32_t>(i));
+			}
+			if (found) {
+				break;
+			}
+		}
+		if (found) {
+			docs[count++] = doc;
+		}
+	}
+	docs.resize(count);
+	return docs;
+}
+
+//  ,   ,  
+std::vector<uint32_t> match(const QueryNode& node, const Segment& segment)
+{
+	switch (node.type) {
+	case QueryNode::Type::Term: {
+		const auto* entry = segment.find(node.words.front());
+		return entry ? termDocs(segment, *entry) : std::vector<uint32_t>();
+	}
+	case QueryNode::Type::Phrase:
+		return matchPhrase(segment, node.words);
+	case QueryNode::Type::Or: {
+		std::vector<uint32_t> docs;
+		for (const auto& child : node.children) {
+			posting_lists::unite(docs, match(child, segment), docs);
+		}
+		return docs;
+	}
+	case QueryNode::Type::And: {
+		std::vector<std::string> terms;
+		std::vector<std::vector<uint32_t>> lists;
+		for (const auto& child : node.children) {
+			if (child.type == QueryNode::Type::Term) {
+				terms.push_back(child.words.front());
+			}
+			else if (child.type != QueryNode::Type::Not) {
+				lists.push_back(match(child, segment));
+				if (lists.back().empty()) {
+					return {};
+				}
+			}
+		}
+		std::vector<uint32_t> docs = matchAll(segment, terms, std::move(lists));
+
+		for (const auto& child : node.children) {
+			if (child.type != QueryNode::Type::Not || docs.empty()) {
+				continue;
+			}
+			const QueryNode& excluded = child.children.front();
+			if (excluded.type == QueryNode::Type::Term) {
+				if (const auto* entry = segment.find(excluded.words.front())) {
+					filterByTerm(docs, segment, *entry, false);
+				}
+			}
+			else {
+				posting_lists::subtract(docs, match(excluded, segment), docs);
+			}
+		}
+		return docs;
+	}
+	default:
+		throw std::logic_error("NOT is only allowed inside AND");
+	}
+}
+
+}
+
+IndexReader::IndexReader(const Config::Index& settings)
+	: directory_(settings.path), k1_(settings.bm25K1), b_(settings.bm25B), snapshot_(std::make_shared<Snapshot>())
+{
+	refresh();
+}
+
+std::shared_ptr<const IndexReader::Snapshot> IndexReader::current() const
+{
+	std::lock_guard<std::mutex> lock(m_);
+	return snapshot_;
+}
+
+void IndexReader::refresh()
+{
+	auto old = current();
+
+	index_files::Manifest manifest;
+	if (index_files::readManifest(directory_, manifest)) {
+		if (manifest.version == old->version && !old->segments.empty()) {
+			return;
+		}
+	}
+	else {
+		manifest.segments = index_files::listSegments(directory_); //   
+	}
+
+	auto next = std::make_shared<Snapshot>();
+	next->version = manifest.version;
+
+	for (auto it = manifest.segments.rbegin(); it != manifest.segments.rend(); ++it) {
+		//    ,  
+		auto found = std::find_if(old->segments.begin(), old->segments.end(),
+			[&](const std::shared_ptr<Segment>& segment) { return segment->generation() == *it; });
+		if (found != old->segments.end()) {
+			next->segments.push_back(*found);
+			continue;
+		}
+		try {
+			next->segments.push_back(Segment::open(index_files::segmentPath(directory_, *it), *it));
+		}
+		catch (const std::exception& e) {
+			//     :       
+			std::cerr << e.what() << std::endl;
+			return;
+		}
+	}
+
+	for (const auto& segment : next->segments) {
+		next->docCount += segment->liveDocCount();
+		next->totalLength += segment->totalLength();
+	}
+
+	std::lock_guard<std::mutex> lock(m_);
+	snapshot_ = std::move(next);
+}
+
+double IndexReader::weight(double idf, uint32_t tf, uint32_t length, double avgLength) const
+{
+	double norm = k1_ * (1.0 - b_ + b_ * length / avgLength);
+	return idf * tf * (k1_ + 1.0) / (tf + norm);
+}
+
+double IndexReader::averageLength(const Snapshot& snapshot)
+{
+	return snapshot.docCount && snapshot.totalLength ? static_cast<double>(snapshot.totalLength) / snapshot.docCount : 1.0;
+}
+
+std::vector<double> IndexReader::inverseFrequencies(const Snapshot& snapshot, const std::vector<std::string>& terms)
+{
+	//   -   :  
+	//    ,  idf  
+	double docCount = static_cast<double>(std::max<uint64_t>(snapshot.docCount, 1));
+	std::vector<double> idf(terms.size(), 0.0);
+	for (size_t t = 0; t < terms.size(); t++) {
+		uint64_t docFreq = 0;
+		for (const auto& segment : snapshot.segments) {
+			if (const auto* entry = segment->find(terms[t])) {
+				docFreq += entry->docFreq;
+			}
+		}
+		idf[t] = std::log(1.0 + (docCount - docFreq + 0.5) / (docFreq + 0.5));
+	}
+	return idf;
+}
+
+void IndexReader::offer(const Snapshot& snapshot, size_t segment, SearchHit hit, std::vector<SearchHit>& heap, size_t k)
+{
+	if (heap.size() == k && !betterHit(hit, heap.front())) {
+		return;
+	}
+	// ,  ,     
+	for (size_t j = 0; j < segment; j++) {
+		if (snapshot.segments[j]->contains(hit.docId)) {
+			return;
+		}
+	}
+	if (heap.size() == k) {
+		std::pop_heap(heap.begin(), heap.end(), betterHit);
+		heap.pop_back();
+	}
+	heap.push_back(hit);
+	std::push_heap(heap.begin(), heap.end(), betterHit);
+}
+
+std::vector<SearchHit> IndexReader::search(const QueryNode& query, size_t k) const
+{
+	std::vector<std::string> terms;
+	if (query.isDisjunction(&terms)) {
+		return search(terms, k);
+	}
+
+	auto snapshot = current();
+	const auto& segments = snapshot->segments;
+
+	query.positiveWords(terms);
+	std::sort(terms.begin(), terms.end());
+	terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+	std::vector<SearchHit> heap;
+	if (k == 0 || segments.empty()) {
+		return heap;
+	}
+
+	double avgLength = averageLength(*snapshot);
+	std::vector<double> idf = inverseFrequencies(*snapshot, terms);
+
+	for (size_t i = 0; i < segments.size(); i++) {
+		const Segment& segment = *segments[i];
+		std::vector<uint32_t> docs = match(query, segment);
+		if (docs.empty()) {
+			continue;
+		}
+
+		//   :      ,  
+		std::vector<TermCursor> cursors;
+		for (size_t t = 0; t < terms.size(); t++) {
+			if (const auto* entry = segment.find(terms[t])) {
+				cursors.push_back({segment.postings(*entry), idf[t], 0.0});
+			}
+		}
+
+		for (uint32_t doc : docs) {
+			uint32_t length = segment.docLength(doc);
+			double score = 0;
+			for (auto& cursor : cursors) {
+				cursor.cursor.advance(doc);
+				if (cursor.cursor.valid() && cursor.cursor.doc() == doc) {
+					score += weight(cursor.idf, cursor.cursor.tf(), length, avgLength);
+				}
+			}
+			offer(*snapshot, i, {doc, score}, heap, k);
+		}
+	}
+
+	std::sort_heap(heap.begin(), heap.end(), betterHit);
+	return heap;
+}
+
+std::vector<SearchHit> IndexReader::search(const std::vector<std::string>& words, size_t k) const
+{
+	auto snapshot = current();
+	const auto& segments = snapshot->segments;
+
+	std::vector<std::string> terms = words;
+	std::sort(terms.begin(), terms.end());
+	terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+	std::vector<SearchHit> heap;
+	if (k == 0 || segments.empty()) {
+		return heap;
+	}
+
+	double avgLength = averageLength(*snapshot);
+	std::vector<double> idf = inverseFrequencies(*snapshot, terms);
+
+	//  k ,   -   ;    
+	auto threshold = [&]() { return heap.size() < k ? 0.0 : heap.front().score; };
+
+	for (size_t i = 0; i < segments.size(); i++) {
+		const Segment& segment = *segments[i];
+
+		std::vector<TermCursor> cursors;
+		for (size_t t = 0; t < terms.size(); t++) {
+			const auto* entry = segment.find(terms[t]);
+			if (!entry) {
+				continue;
+			}
+			cursors.push_back({segment.postings(*entry), idf[t], weight(idf[t], entry->maxTf, entry->minLength, avgLength)});
+		}
+
+		std::vector<TermCursor*> order;
+		for (auto& cursor : cursors) {
+			order.push_back(&cursor);
+		}
+
+		while (true) {
+			order.erase(std::remove_if(order.begin(), order.end(),
+				[](const TermCursor* cursor) { return !cursor->cursor.valid(); }), order.end());
+			std::sort(order.begin(), order.end(), [](const TermCursor* a, const TermCursor* b) {
+				return a->cursor.doc() < b->cursor.doc();
+				});
+
+			//  : ,      
+			double limit = threshold();
+			double upper = 0;
+			size_t pivot = 0;
+			while (pivot < order.size()) {
+				upper += order[pivot]->bound;
+				if (upper > limit) {
+					break;
+				}
+				pivot++;
+			}
+			if (pivot == order.size()) {
+				break; //         k
+			}
+			uint32_t pivotDoc = order[pivot]->cursor.doc();
+			while (pivot + 1 < order.size() && order[pivot + 1]->cursor.doc() == pivotDoc) {
+				pivot++;
+			}
+
+			if (order[0]->cursor.doc() != pivotDoc) {
+				for (size_t p = 0; order[p]->cursor.doc() < pivotDoc; p++) {
+					order[p]->cursor.advance(pivotDoc);
+				}
+				continue;
+			}
+
+			//       pivotDoc:      
+			double blockUpper = 0;
+			uint32_t blockEnd = UINT32_MAX;
+			for (size_t p = 0; p <= pivot; p++) {
+				const auto& cursor = order[p]->cursor;
+				blockUpper += weight(order[p]->idf, cursor.blockMaxTf(), cursor.blockMinLength(), avgLength);
+				blockEnd = std::min(blockEnd, cursor.blockLastDoc());
+			}
+			if (blockUpper <= limit && blockEnd != UINT32_MAX) {
+				//          
+				uint32_t target = blockEnd + 1;
+				if (pivot + 1 < order.size()) {
+					target = std::min(target, order[pivot + 1]->cursor.doc());
+				}
+				for (size_t p = 0; p <= pivot; p++) {
+					order[p]->cursor.advance(target);
+				}
+				continue;
+			}
+
+			uint32_t length = segment.docLength(pivotDoc);
+			double score = 0;
+			for (size_t p = 0; p <= pivot; p++) {
+				score += weight(order[p]->idf, order[p]->cursor.tf(), length, avgLength);
+			}
+
+			offer(*snapshot, i, {pivotDoc, score}, heap, k);
+
+			for (size_t p = 0; p <= pivot; p++) {
+				order[p]->cursor.next();
+			}
+		}
+	}
+
+	std::sort_heap(heap.begin(), heap.end(), betterHit);
+	return heap;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+#include "segment.h"
+#include "query.h"
+#include "../Config/config.h"
+
+struct SearchHit {
+	uint32_t docId;
+	double score;
+};
+
+//    .    -    :
+// refresh()   ,     ,
+//        
+class IndexReader {
+public:
+	explicit IndexReader(const Config::Index& settings);
+
+	//   ,      
+	void refresh();
+
+	// k   BM25 ,    .
+	//    WAND:  ,     
+	//   (     )  k-   
+	std::vector<SearchHit> search(const std::vector<std::string>& words, size_t k) const;
+
+	// k   BM25 ,   ;    NOT.
+	//  AND      ,    
+	std::vector<SearchHit> search(const QueryNode& query, size_t k) const;
+
+	IndexReader(const IndexReader&) = delete;
+	IndexReader& operator=(const IndexReader&) = delete;
+
+private:
+	struct Snapshot {
+		uint64_t version = 0;  //  
+		std::vector<std::shared_ptr<Segment>> segments;  //   - 
+		uint64_t docCount = 0;     //    BM25
+		uint64_t totalLength = 0;
+	};
+
+	struct TermCursor {
+		PostingCursor cursor;
+		double idf;
+		double bound;  //      
+	};
+
+	std::string directory_;
+	double k1_;
+	double b_;
+	mutable std::mutex m_;
+	std::shared_ptr<const Snapshot> snapshot_;
+
+	std::shared_ptr<const Snapshot> current() const;
+
+	//    BM25;    tf     
+	double weight(double idf, uint32_t tf, uint32_t length, double avgLength) const;
+
+	static double averageLength(const Snapshot& snapshot);
+	static std::vector<double> inverseFrequencies(const Snapshot& snapshot, const std::vector<std::string>& terms);
+	//      k ,       
+	static void offer(const Snapshot& snapshot, size_t segment, SearchHit hit, std::vector<SearchHit>& heap, size_t k);
+};
@@ -0,0 +1,402 @@
+//  :        ,    
+//    ,    , WAND    k ,  
+//  BM25   ,        
+//  .     .
+//   IndexTests
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <filesystem>
+#include <iterator>
+#include <cmath>
+#include <thread>
+#include <chrono>
+
+#include "posting_lists.h"
+#include "index_writer.h"
+#include "index_reader.h"
+#include "query.h"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what)
+{
+	if (!condition) {
+		std::cout << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+using Document = std::unordered_map<std::string, std::vector<uint32_t>>;
+
+std::vector<uint32_t> randomList(std::mt19937& random, size_t size, uint32_t range)
+{
+	std::uniform_int_distribution<uint32_t> value(0, range);
+	std::vector<uint32_t> list;
+	for (size_t i = 0; i < size; i++) {
+		list.push_back(value(random));
+	}
+	std::sort(list.begin(), list.end());
+	list.erase(std::unique(list.begin(), list.end()), list.end());
+	return list;
+}
+
+void testIntersect()
+{
+	using posting_lists::Method;
+	std::mt19937 random(7);
+	//   ,    , ,   SSE2
+	const std::vector<std::pair<size_t, size_t>> sizes = {
+		{0, 0}, {0, 100}, {1, 1}, {3, 5}, {4, 4}, {7, 9}, {100, 100}, {1000, 1200}, {10, 5000}, {3, 20000}, {5000, 5000},
+	};
+	for (const auto& size : sizes) {
+		for (uint32_t range : {16u, 1000u, 100000u}) {
+			std::vector<uint32_t> a = randomList(random, size.first, range);
+			std::vector<uint32_t> b = randomList(random, size.second, range);
+			std::vector<uint32_t> expected;
+			std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+
+			std::string name = std::to_string(a.size()) + " x " + std::to_string(b.size()) + " of " + std::to_string(range);
+			for (Method method : {Method::Auto, Method::Scalar, Method::Gallop, Method::Sse2}) {
+				std::vector<uint32_t> out;
+				posting_lists::intersect(a, b, out, method);
+				check(out == expected, "intersect method " + std::to_string(static_cast<int>(method)) + ", " + name);
+				posting_lists::intersect(b, a, out, method);
+				check(out == expected, "intersect method " + std::to_string(static_cast<int>(method)) + ", swapped " + name);
+			}
+			//      ,   index_reader
+			std::vector<uint32_t> inPlace = a;
+			posting_lists::intersect(inPlace, b, inPlace);
+			check(inPlace == expected, "intersect in place, " + name);
+		}
+	}
+
+	std::vector<uint32_t> list = {1, 3, 5, 7, 9, 11};
+	check(posting_lists::gallop(list.data(), 0, list.size(), 0) == 0, "gallop before first");
+	check(posting_lists::gallop(list.data(), 0, list.size(), 7) == 3, "gallop exact");
+	check(posting_lists::gallop(list.data(), 2, list.size(), 8) == 4, "gallop between");
+	check(posting_lists::gallop(list.data(), 0, list.size(), 12) == list.size(), "gallop after last");
+}
+
+//  :     1,       
+std::vector<std::pair<uint32_t, Document>> makeCorpus(size_t count)
+{
+	static const std::vector<std::string> vocabulary = {
+		"apple", "banana", "cherry", "grape", "lemon", "mango", "melon", "peach", "pear", "plum",
+	};
+	std::mt19937 random(11);
+	std::uniform_int_distribution<size_t> length(1, 40);
+	std::vector<std::pair<uint32_t, Document>> corpus;
+	for (uint32_t id = 1; id <= count; id++) {
+		Document doc;
+		size_t n = length(random);
+		for (uint32_t position = 0; position < n; position++) {
+			//     
+			std::uniform_int_distribution<size_t> word(0, std::uniform_int_distribution<size_t>(0, vocabulary.size() - 1)(random));
+			doc[vocabulary[word(random)]].push_back(position);
+		}
+		corpus.push_back({id, std::move(doc)});
+	}
+	return corpus;
+}
+
+bool hasPhrase(const Document& doc, const std::vector<std::string>& words)
+{
+	auto first = doc.find(words.front());
+	if (first == doc.end()) {
+		return false;
+	}
+	for (uint32_t start : first->second) {
+		bool found = true;
+		for (size_t i = 1; i < words.size() && found; i++) {
+			auto it = doc.find(words[i]);
+			found = it != doc.end() && std::count(it->second.begin(), it->second.end(), start + i) > 0;
+		}
+		if (found) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool matches(const QueryNode& node, const Document& doc)
+{
+	switch (node.type) {
+	case QueryNode::Type::Term:
+		return doc.count(node.words.front()) > 0;
+	case QueryNode::Type::Phrase:
+		return hasPhrase(doc, node.words);
+	case QueryNode::Type::Not:
+		return !matches(node.children.front(), doc);
+	case QueryNode::Type::And:
+		return std::all_of(node.children.begin(), node.children.end(), [&](const QueryNode& child) { return matches(child, doc); });
+	case QueryNode::Type::Or:
+		return std::any_of(node.children.begin(), node.children.end(), [&](const QueryNode& child) { return matches(child, doc); });
+	}
+	return false;
+}
+
+QueryNode term(const std::string& word)
+{
+	QueryNode node;
+	node.words = {word};
+	return node;
+}
+
+QueryNode phrase(const std::vector<std::string>& words)
+{
+	QueryNode node;
+	node.type = QueryNode::Type::Phrase;
+	node.words = words;
+	return node;
+}
+
+QueryNode operation(QueryNode::Type type, std::vector<QueryNode> children)
+{
+	QueryNode node;
+	node.type = type;
+	node.children = std::move(children);
+	return node;
+}
+
+QueryNode negation(QueryNode child)
+{
+	return operation(QueryNode::Type::Not, {std::move(child)});
+}
+
+// BM25        ,   IndexReader
+std::vector<SearchHit> exhaustiveSearch(const std::vector<std::pair<uint32_t, Document>>& corpus,
+	const std::vector<std::string>& words, const Config::Index& settings, size_t k)
+{
+	double docCount = static_cast<double>(corpus.size());
+	double totalLength = 0;
+	for (const auto& doc : corpus) {
+		for (const auto& word : doc.second) {
+			totalLength += word.second.size();
+		}
+	}
+	double avgLength = totalLength / docCount;
+
+	std::vector<SearchHit> hits;
+	for (const auto& doc : corpus) {
+		double length = 0;
+		for (const auto& word : doc.second) {
+			length += word.second.size();
+		}
+		double score = 0;
+		bool found = false;
+		for (const auto& word : words) {
+			size_t docFreq = 0;
+			for (const auto& other : corpus) {
+				docFreq += other.second.count(word);
+			}
+			auto it = doc.second.find(word);
+			if (it == doc.second.end()) {
+				continue;
+			}
+			found = true;
+			double idf = std::log(1.0 + (docCount - docFreq + 0.5) / (docFreq + 0.5));
+			double tf = static_cast<double>(it->second.size());
+			double norm = settings.bm25K1 * (1.0 - settings.bm25B + settings.bm25B * length / avgLength);
+			score += idf * tf * (settings.bm25K1 + 1.0) / (tf + norm);
+		}
+		if (found) {
+			hits.push_back({doc.first, score});
+		}
+	}
+	std::sort(hits.begin(), hits.end(), [](const SearchHit& a, const SearchHit& b) {
+		return a.score != b.score ? a.score > b.score : a.docId < b.docId;
+		});
+	if (hits.size() > k) {
+		hits.resize(k);
+	}
+	return hits;
+}
+
+//    : WAND      
+bool sameHits(const std::vector<SearchHit>& actual, const std::vector<SearchHit>& expected)
+{
+	if (actual.size() != expected.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < actual.size(); i++) {
+		if (std::abs(actual[i].score - expected[i].score) > 1e-9) {
+			return false;
+		}
+		//         
+		bool tied = (i > 0 && std::abs(expected[i - 1].score - expected[i].score) <= 1e-9)
+			|| (i + 1 < expected.size() && std::abs(expected[i + 1].score - expected[i].score) <= 1e-9);
+		if (!tied && actual[i].docId != expected[i].docId) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void testIndex(const std::string& directory)
+{
+	Config::Index settings;
+	settings.path = directory;
+	settings.mergeFactor = 100; //   :     
+
+	auto corpus = makeCorpus(3000);
+	{
+		IndexWriter writer(settings);
+		for (size_t i = 0; i < corpus.size(); i++) {
+			writer.add(corpus[i].first, corpus[i].second);
+			if ((i + 1) % 1000 == 0) {
+				writer.flush();
+			}
+		}
+		check(writer.stats().segments == 3, "three segments written");
+	}
+
+	IndexReader reader(settings);
+
+	const std::vector<std::pair<std::string, QueryNode>> queries = {
+		{"term", term("melon")},
+		{"phrase", phrase({"apple", "banana"})},
+		{"long phrase", phrase({"apple", "apple", "banana"})},
+		{"and", operation(QueryNode::Type::And, {term("cherry"), term("grape")})},
+		{"and not", operation(QueryNode::Type::And, {term("apple"), negation(term("banana"))})},
+		{"and not phrase", operation(QueryNode::Type::And, {term("cherry"), negation(phrase({"apple", "banana"}))})},
+		{"and with or", operation(QueryNode::Type::And, {
+			term("lemon"), operation(QueryNode::Type::Or, {term("mango"), phrase({"banana", "apple"})})})},
+		{"or of and", operation(QueryNode::Type::Or, {
+			operation(QueryNode::Type::And, {term("peach"), term("pear")}), term("plum")})},
+		{"missing word", operation(QueryNode::Type::And, {term("apple"), term("kiwi")})},
+	};
+	for (const auto& query : queries) {
+		std::vector<uint32_t> expected;
+		for (const auto& doc : corpus) {
+			if (matches(query.second, doc.second)) {
+				expected.push_back(doc.first);
+			}
+		}
+		std::vector<SearchHit> hits = reader.search(query.second, corpus.size());
+		std::vector<uint32_t> found;
+		for (const auto& hit : hits) {
+			found.push_back(hit.docId);
+		}
+		std::sort(found.begin(), found.end());
+		check(found == expected, "query '" + query.first + "': " + std::to_string(found.size())
+			+ " documents instead of " + std::to_string(expected.size()));
+	}
+
+	const std::vector<std::vector<std::string>> disjunctions = {
+		{"apple"}, {"plum"}, {"apple", "banana"}, {"pear", "plum", "kiwi"},
+		{"apple", "banana", "cherry", "grape", "lemon", "mango", "melon", "peach", "pear", "plum"},
+	};
+	for (const auto& words : disjunctions) {
+		for (size_t k : {1, 10, 100, 5000}) {
+			std::string name;
+			for (const auto& word : words) {
+				name += " " + word;
+			}
+			check(sameHits(reader.search(words, k), exhaustiveSearch(corpus, words, settings, k)),
+				"WAND top " + std::to_string(k) + " for" + name);
+		}
+	}
+}
+
+//   (   )   .    
+//  ,  ,     BM25;       
+void testEmptyDocuments(const std::string& directory, bool merge)
+{
+	Config::Index settings;
+	settings.path = directory;
+	settings.mergeFactor = merge ? 2 : 100;
+
+	auto corpus = makeCorpus(600);
+	const uint32_t removed = 100; //  1..removed  
+	std::string name = merge ? "merged" : "unmerged";
+	{
+		IndexWriter writer(settings);
+		for (size_t i = 0; i < corpus.size(); i++) {
+			writer.add(corpus[i].first, corpus[i].second);
+			if (i + 1 == corpus.size() / 2) {
+				writer.flush();
+			}
+		}
+		writer.flush();
+		for (uint32_t id = 1; id <= removed; id++) {
+			writer.add(id, {});
+		}
+		writer.flush();
+
+		//    : ,     
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (merge && writer.stats().segments > 1 && std::chrono::steady_clock::now() < deadline) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+
+	index_files::Manifest manifest;
+	check(index_files::readManifest(directory, manifest), name + ": manifest written");
+	uint64_t docs = 0;
+	uint64_t liveDocs = 0;
+	for (uint64_t id : manifest.segments) {
+		auto segment = Segment::open(index_files::segmentPath(directory, id), id);
+		docs += segment->docCount();
+		liveDocs += segment->liveDocCount();
+	}
+	if (merge) {
+		check(manifest.segments.size() == 1, name + ": segments merged into one");
+		check(liveDocs == corpus.size() - removed, name + ": live documents " + std::to_string(liveDocs));
+		check(docs == liveDocs, name + ": empty documents dropped by the merge, " + std::to_string(docs - liveDocs) + " left");
+	}
+	else {
+		//             ,
+		//   - 
+		check(docs == corpus.size() + removed, name + ": empty documents stored");
+		check(liveDocs == corpus.size(), name + ": live documents " + std::to_string(liveDocs));
+	}
+
+	IndexReader reader(settings);
+	for (const auto& hit : reader.search(term("apple"), corpus.size())) {
+		check(hit.docId > removed, name + ": removed document " + std::to_string(hit.docId) + " found");
+	}
+
+	//     ,        
+	if (merge) {
+		std::vector<std::pair<uint32_t, Document>> remaining(corpus.begin() + removed, corpus.end());
+		for (const auto& words : std::vector<std::vector<std::string>>{{"apple"}, {"pear", "plum"}}) {
+			check(sameHits(reader.search(words, 10), exhaustiveSearch(remaining, words, settings, 10)),
+				name + ": WAND top 10 for " + words.front());
+		}
+	}
+}
+
+}
+
+int main()
+{
+	testIntersect();
+
+	std::filesystem::path directory = std::filesystem::temp_directory_path()
+		/ ("index_tests_" + std::to_string(std::random_device()()));
+	try {
+		testIndex(directory.string());
+		testEmptyDocuments((directory / "unmerged").string(), false);
+		testEmptyDocuments((directory / "merged").string(), true);
+	}
+	catch (const std::exception& e) {
+		std::cout << "FAILED: " << e.what() << std::endl;
+		failures++;
+	}
+	std::error_code ec;
+	std::filesystem::remove_all(directory, ec);
+
+	if (failures) {
+		std::cout << failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,333 @@
+#include "index_writer.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <cmath>
+
+namespace {
+
+//      ,   
+constexpr size_t minTierBytes = 1024 * 1024;
+
+//     :   
+constexpr std::chrono::seconds mergeRetryMin(1);
+constexpr std::chrono::seconds mergeRetryMax(60);
+
+//   :  ,   ,    .
+//   ,       :    
+//   (dropEmpty),       
+void mergeSegments(const std::vector<std::shared_ptr<Segment>>& inputs, const std::string& path, bool dropEmpty)
+{
+	std::vector<index_format::DocEntry> docs;
+	for (size_t i = 0; i < inputs.size(); i++) {
+		const auto* begin = inputs[i]->docs();
+		for (const auto* doc = begin; doc != begin + inputs[i]->docCount(); doc++) {
+			bool shadowed = false;
+			for (size_t j = i + 1; j < inputs.size() && !shadowed; j++) {
+				shadowed = inputs[j]->contains(doc->docId);
+			}
+			if (!shadowed && !(dropEmpty && doc->length == 0)) {
+				docs.push_back(*doc);
+			}
+		}
+	}
+	std::sort(docs.begin(), docs.end(), [](const index_format::DocEntry& a, const index_format::DocEntry& b) {
+		return a.docId < b.docId;
+		});
+
+	//    
+	std::vector<uint32_t> positions(inputs.size(), 0);
+	std::vector<Posting> postings;
+	std::vector<uint32_t> termPositions;
+	std::vector<uint32_t> docPositions;
+	SegmentFileWriter writer(path, std::move(docs));
+
+	while (true) {
+		std::string_view term;
+		bool found = false;
+		for (size_t i = 0; i < inputs.size(); i++) {
+			if (positions[i] < inputs[i]->termCount()) {
+				std::string_view candidate = inputs[i]->termText(inputs[i]->termAt(positions[i]));
+				if (!found || candidate < term) {
+					term = candidate;
+					found = true;
+				}
+			}
+		}
+		if (!found) {
+			break;
+		}
+
+		std::string current(term);
+		postings.clear();
+		termPositions.clear();
+		for (size_t i = 0; i < inputs.size(); i++) {
+			if (positions[i] >= inputs[i]->termCount()) {
+				continue;
+			}
+			const auto& entry = inputs[i]->termAt(positions[i]);
+			if (inputs[i]->termText(entry) != current) {
+				continue;
+			}
+			positions[i]++;
+			for (auto cursor = inputs[i]->postings(entry); cursor.valid(); cursor.next()) {
+				bool shadowed = false;
+				for (size_t j = i + 1; j < inputs.size() && !shadowed; j++) {
+					shadowed = inputs[j]->contains(cursor.doc());
+				}
+				if (!shadowed) {
+					cursor.positions(docPositions);
+					postings.push_back({cursor.doc(), cursor.tf(), termPositions.size()});
+					termPositions.insert(termPositions.end(), docPositions.begin(), docPositions.end());
+				}
+			}
+		}
+		std::sort(postings.begin(), postings.end(), [](const Posting& a, const Posting& b) { return a.docId < b.docId; });
+		writer.addTerm(current, postings, termPositions);
+	}
+
+	writer.finish();
+}
+
+}
+
+IndexWriter::IndexWriter(const Config::Index& settings)
+	: directory_(settings.path),
+	memoryBudget_(settings.memoryBudget),
+	flushInterval_(settings.flushInterval),
+	mergeFactor_(std::max<size_t>(settings.mergeFactor, 2)),
+	bufferStarted_(std::chrono::steady_clock::now())
+{
+	std::filesystem::create_directories(directory_);
+
+	index_files::Manifest manifest;
+	if (!index_files::readManifest(directory_, manifest)) {
+		manifest.segments = index_files::listSegments(directory_); //   :   
+	}
+	manifestVersion_ = manifest.version;
+
+	for (uint64_t id : manifest.segments) {
+		segments_.push_back({id, Segment::open(index_files::segmentPath(directory_, id), id)});
+	}
+	for (uint64_t id : index_files::listSegments(directory_)) {
+		nextId_ = std::max(nextId_, id + 1);
+		if (std::find(manifest.segments.begin(), manifest.segments.end(), id) == manifest.segments.end()) {
+			obsolete_.push_back(id); //       
+		}
+	}
+
+	publish();
+	merger_ = std::thread(&IndexWriter::mergeLoop, this);
+}
+
+IndexWriter::~IndexWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		stopping_ = true; //   ,   
+	}
+	mergeCondition_.notify_all();
+	if (merger_.joinable()) {
+		merger_.join();
+	}
+}
+
+void IndexWriter::add(uint32_t docId, const std::unordered_map<std::string, std::vector<uint32_t>>& wordPositions)
+{
+	std::lock_guard<std::mutex> lock(bufferMutex_);
+	if (builder_.empty()) {
+		bufferStarted_ = std::chrono::steady_clock::now();
+	}
+	builder_.add(docId, wordPositions);
+}
+
+bool IndexWriter::flushIfNeeded()
+{
+	//     :    ,     
+	std::unique_lock<std::mutex> flushLock(flushMutex_, std::try_to_lock);
+	if (!flushLock.owns_lock()) {
+		return false;
+	}
+	{
+		std::lock_guard<std::mutex> lock(bufferMutex_);
+		if (!builder_.empty() && (builder_.memory() >= memoryBudget_
+			|| std::chrono::steady_clock::now() - bufferStarted_ >= flushInterval_)) {
+			detachBuffer();
+		}
+	}
+	return writePending();
+}
+
+bool IndexWriter::flush()
+{
+	std::lock_guard<std::mutex> flushLock(flushMutex_);
+	{
+		std::lock_guard<std::mutex> lock(bufferMutex_);
+		if (!builder_.empty()) {
+			detachBuffer();
+		}
+	}
+	return writePending();
+}
+
+//   flushMutex_  bufferMutex_
+void IndexWriter::detachBuffer()
+{
+	pending_.push_back(std::move(builder_));
+	builder_ = SegmentBuilder();
+}
+
+//   flushMutex_.    bufferMutex_: add      
+bool IndexWriter::writePending()
+{
+	bool published = false;
+	while (!pending_.empty()) {
+		uint64_t id;
+		{
+			std::lock_guard<std::mutex> lock(m_);
+			id = nextId_++;
+		}
+
+		std::string path = index_files::segmentPath(directory_, id);
+		pending_.front().write(path); //      
+		auto segment = Segment::open(path, id);
+		pending_.pop_front();
+
+		{
+			std::lock_guard<std::mutex> lock(m_);
+			segments_.push_back({id, std::move(segment)});
+			flushes_++;
+			publish();
+		}
+		mergeCondition_.notify_one();
+		published = true;
+	}
+	return published;
+}
+
+//   m_
+void IndexWriter::publish()
+{
+	index_files::Manifest manifest;
+	manifest.version = ++manifestVersion_;
+	for (const auto& entry : segments_) {
+		manifest.segments.push_back(entry.id);
+	}
+	index_files::writeManifest(directory_, manifest);
+	removeObsolete();
+}
+
+//   m_. ,  ,      -  
+void IndexWriter::removeObsolete()
+{
+	std::vector<uint64_t> remaining;
+	for (uint64_t id : obsolete_) {
+		std::error_code ec;
+		std::filesystem::remove(index_files::segmentPath(directory_, id), ec);
+		if (ec) {
+			remaining.push_back(id);
+		}
+	}
+	obsolete_.swap(remaining);
+}
+
+int IndexWriter::tier(size_t bytes) const
+{
+	if (bytes < minTierBytes) {
+		return 0;
+	}
+	return 1 + static_cast<int>(std::log(static_cast<double>(bytes) / minTierBytes) / std::log(static_cast<double>(mergeFactor_)));
+}
+
+//   m_.      mergeFactor    :
+//   ,      
+bool IndexWriter::pickMerge(size_t& start) const
+{
+	size_t run = 0;
+	for (size_t i = segments_.size(); i-- > 0;) {
+		if (run > 0 && tier(segments_[i].segment->bytes()) == tier(segments_[i + 1].segment->bytes())) {
+			run++;
+		}
+		else {
+			run = 1;
+		}
+		if (run == mergeFactor_) {
+			start = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+void IndexWriter::mergeLoop()
+{
+	std::unique_lock<std::mutex> lock(m_);
+	auto backoff = mergeRetryMin;
+	while (true) {
+		size_t start = 0;
+		mergeCondition_.wait(lock, [&] { return stopping_ || pickMerge(start); });
+		if (stopping_) {
+			return;
+		}
+
+		std::vector<std::shared_ptr<Segment>> inputs;
+		std::vector<uint64_t> inputIds;
+		for (size_t i = start; i < start + mergeFactor_; i++) {
+			inputs.push_back(segments_[i].segment);
+			inputIds.push_back(segments_[i].id);
+		}
+		uint64_t id = nextId_++;
+
+		//   :         
+		lock.unlock();
+		std::shared_ptr<Segment> merged;
+		std::string path = index_files::segmentPath(directory_, id);
+		try {
+			mergeSegments(inputs, path, start == 0);
+			merged = Segment::open(path, id);
+		}
+		catch (const std::exception& e) {
+			std::cerr << "    ,   "
+				<< backoff.count() << " : " << e.what() << std::endl;
+			std::error_code ec;
+			std::filesystem::remove(path + ".tmp", ec);
+		}
+		inputs.clear();
+		lock.lock();
+
+		if (!merged) {
+			//   :    .  
+			//     ,    
+			failedMerges_++;
+			obsolete_.push_back(id);
+			removeObsolete();
+			mergeCondition_.wait_for(lock, backoff, [this] { return stopping_; });
+			backoff = std::min(backoff * 2, mergeRetryMax);
+			continue;
+		}
+		backoff = mergeRetryMin;
+
+		segments_.erase(segments_.begin() + start, segments_.begin() + start + mergeFactor_);
+		segments_.insert(segments_.begin() + start, {id, std::move(merged)});
+		obsolete_.insert(obsolete_.end(), inputIds.begin(), inputIds.end());
+		merges_++;
+		publish();
+	}
+}
+
+IndexWriter::Stats IndexWriter::stats() const
+{
+	Stats result;
+	{
+		std::lock_guard<std::mutex> lock(m_);
+		result.segments = segments_.size();
+		result.flushes = flushes_;
+		result.merges = merges_;
+		result.failedMerges = failedMerges_;
+		for (const auto& entry : segments_) {
+			result.bytes += entry.segment->bytes();
+		}
+	}
+	return result;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <deque>
+#include <cstdint>
+
+#include "segment.h"
+#include "../Config/config.h"
+
+//     LSM:          
+//   ,    memoryBudget   flushInterval.
+//    mergeFactor       .
+//    ,    .
+//      ,        :
+// add   ,   ,  
+class IndexWriter {
+public:
+	struct Stats {
+		size_t segments = 0;
+		size_t flushes = 0;
+		size_t merges = 0;
+		size_t failedMerges = 0;
+		uint64_t bytes = 0;
+	};
+
+	explicit IndexWriter(const Config::Index& settings);
+	~IndexWriter();
+
+	void add(uint32_t docId, const std::unordered_map<std::string, std::vector<uint32_t>>& wordPositions);
+
+	//  ,        ; true -   
+	bool flushIfNeeded();
+	//   
+	bool flush();
+
+	Stats stats() const;
+
+	IndexWriter(const IndexWriter&) = delete;
+	IndexWriter& operator=(const IndexWriter&) = delete;
+
+private:
+	struct Entry {
+		uint64_t id;
+		std::shared_ptr<Segment> segment;
+	};
+
+	std::string directory_;
+	const size_t memoryBudget_;
+	const std::chrono::seconds flushInterval_;
+	const size_t mergeFactor_;
+
+	std::mutex bufferMutex_;  // ,    add
+	SegmentBuilder builder_;
+	std::chrono::steady_clock::time_point bufferStarted_;
+
+	//    :      .
+	// ,    ,      
+	std::mutex flushMutex_;
+	std::deque<SegmentBuilder> pending_;
+
+	mutable std::mutex m_;    //  
+	std::condition_variable mergeCondition_;
+	std::vector<Entry> segments_;  //    
+	std::vector<uint64_t> obsolete_;  //  ,     
+	uint64_t nextId_ = 1;
+	uint64_t manifestVersion_ = 0;
+	size_t flushes_ = 0;
+	size_t merges_ = 0;
+	size_t failedMerges_ = 0;
+	bool stopping_ = false;
+	std::thread merger_;
+
+	void detachBuffer();
+	bool writePending();
+	void publish();
+	void removeObsolete();
+	bool pickMerge(size_t& start) const;
+	void mergeLoop();
+	int tier(size_t bytes) const;
+};
@@ -0,0 +1,151 @@
+#include "posting_lists.h"
+
+#include <algorithm>
+#include <iterator>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POSTING_LISTS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace posting_lists {
+
+namespace {
+
+//        ,     
+constexpr size_t gallopRatio = 32;
+
+size_t intersectGallop(const uint32_t* small, size_t smallSize, const uint32_t* large, size_t largeSize, uint32_t* out)
+{
+	size_t count = 0;
+	size_t j = 0;
+	for (size_t i = 0; i < smallSize && j < largeSize; i++) {
+		j = gallop(large, j, largeSize, small[i]);
+		if (j < largeSize && large[j] == small[i]) {
+			out[count++] = small[i];
+		}
+	}
+	return count;
+}
+
+size_t intersectScalar(const uint32_t* a, size_t i, size_t na, const uint32_t* b, size_t j, size_t nb,
+	uint32_t* out, size_t count)
+{
+	while (i < na && j < nb) {
+		if (a[i] < b[j]) {
+			i++;
+		}
+		else if (b[j] < a[i]) {
+			j++;
+		}
+		else {
+			out[count++] = a[i];
+			i++;
+			j++;
+		}
+	}
+	return count;
+}
+
+#ifdef POSTING_LISTS_SSE2
+
+//   a       b;
+//    ,     
+size_t intersectSse2(const uint32_t* a, size_t na, const uint32_t* b, size_t nb, uint32_t* out)
+{
+	size_t i = 0;
+	size_t j = 0;
+	size_t count = 0;
+	while (i + 4 <= na && j + 4 <= nb) {
+		__m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		__m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+		__m128i eq = _mm_cmpeq_epi32(va, vb);
+		eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+		eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+		eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+		for (int bit = 0; bit < 4; bit++) {
+			if (mask & (1 << bit)) {
+				out[count++] = a[i + bit];
+			}
+		}
+
+		uint32_t lastA = a[i + 3];
+		uint32_t lastB = b[j + 3];
+		if (lastA <= lastB) {
+			i += 4;
+		}
+		if (lastB <= lastA) {
+			j += 4;
+		}
+	}
+	return intersectScalar(a, i, na, b, j, nb, out, count);
+}
+
+#endif
+
+}
+
+size_t gallop(const uint32_t* data, size_t begin, size_t n, uint32_t target)
+{
+	size_t low = begin;
+	size_t step = 1;
+	while (low + step < n && data[low + step] < target) {
+		low += step;
+		step *= 2;
+	}
+	size_t high = std::min(n, low + step + 1);
+	return std::lower_bound(data + low, data + high, target) - data;
+}
+
+void intersect(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out)
+{
+	intersect(a, b, out, Method::Auto);
+}
+
+void intersect(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out, Method method)
+{
+	const std::vector<uint32_t>& small = a.size() <= b.size() ? a : b;
+	const std::vector<uint32_t>& large = a.size() <= b.size() ? b : a;
+
+	if (method == Method::Auto) {
+		method = small.size() * gallopRatio < large.size() ? Method::Gallop : Method::Sse2;
+	}
+
+	std::vector<uint32_t> result(small.size());
+	size_t count;
+	switch (method) {
+	case Method::Gallop:
+		count = intersectGallop(small.data(), small.size(), large.data(), large.size(), result.data());
+		break;
+#ifdef POSTING_LISTS_SSE2
+	case Method::Sse2:
+		count = intersectSse2(small.data(), small.size(), large.data(), large.size(), result.data());
+		break;
+#endif
+	default:
+		count = intersectScalar(small.data(), 0, small.size(), large.data(), 0, large.size(), result.data(), 0);
+		break;
+	}
+	result.resize(count);
+	out = std::move(result);
+}
+
+void unite(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out)
+{
+	std::vector<uint32_t> result;
+	result.reserve(a.size() + b.size());
+	std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+	out = std::move(result);
+}
+
+void subtract(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out)
+{
+	std::vector<uint32_t> result;
+	result.reserve(a.size());
+	std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+	out = std::move(result);
+}
+
+}
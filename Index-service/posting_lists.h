@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+//       ( )
+namespace posting_lists {
+
+//    [begin, n),  data[i] >= target:  ,   .
+//  -    ,    
+size_t gallop(const uint32_t* data, size_t begin, size_t n, uint32_t target);
+
+// . ,      ,  
+//  ,    -   4  (SSE2)
+void intersect(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out);
+
+//     -  ,        .
+// Sse2      Scalar
+enum class Method { Auto, Scalar, Gallop, Sse2 };
+void intersect(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out, Method method);
+
+void unite(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out);
+
+//   a,    b
+void subtract(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, std::vector<uint32_t>& out);
+
+}
@@ -0,0 +1,70 @@
+#include "query.h"
+
+#include <algorithm>
+
+bool QueryNode::isDisjunction(std::vector<std::string>* terms) const
+{
+	if (type == Type::Term) {
+		if (terms) {
+			terms->push_back(words.front());
+		}
+		return true;
+	}
+	if (type != Type::Or) {
+		return false;
+	}
+	for (const auto& child : children) {
+		if (child.type != Type::Term) {
+			return false;
+		}
+	}
+	if (terms) {
+		for (const auto& child : children) {
+			terms->push_back(child.words.front());
+		}
+	}
+	return true;
+}
+
+void QueryNode::positiveWords(std::vector<std::string>& out) const
+{
+	if (type == Type::Not) {
+		return;
+	}
+	out.insert(out.end(), words.begin(), words.end());
+	for (const auto& child : children) {
+		child.positiveWords(out);
+	}
+}
+
+std::string QueryNode::canonical() const
+{
+	switch (type) {
+	case Type::Term:
+		return words.front();
+	case Type::Phrase: {
+		std::string text = "\"";
+		for (size_t i = 0; i < words.size(); i++) {
+			text += (i > 0 ? " " : "") + words[i];
+		}
+		return text + "\"";
+	}
+	case Type::Not:
+		return "NOT " + children.front().canonical();
+	default:
+		break;
+	}
+
+	std::vector<std::string> operands;
+	for (const auto& child : children) {
+		operands.push_back(child.canonical());
+	}
+	std::sort(operands.begin(), operands.end());
+	operands.erase(std::unique(operands.begin(), operands.end()), operands.end());
+
+	std::string text = type == Type::And ? "(AND" : "(OR";
+	for (const auto& operand : operands) {
+		text += " " + operand;
+	}
+	return text + ")";
+}
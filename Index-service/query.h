@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//   . NOT     AND,
+//        
+struct QueryNode {
+	enum class Type { Term, Phrase, And, Or, Not };
+
+	Type type = Type::Term;
+	std::vector<std::string> words;   // Term -  , Phrase -  
+	std::vector<QueryNode> children;  // And, Or - , Not -  
+
+	//  -     OR;  terms   
+	bool isDisjunction(std::vector<std::string>* terms = nullptr) const;
+
+	// ,   : ,    NOT
+	void positiveWords(std::vector<std::string>& out) const;
+
+	//  :   ,    AND  OR
+	std::string canonical() const;
+};
@@ -0,0 +1,504 @@
+#include "segment.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "varint.h"
+
+using namespace index_format;
+
+std::string index_files::segmentPath(const std::string& directory, uint64_t generation)
+{
+	char name[64];
+	std::snprintf(name, sizeof(name), "segment_%012llu.idx", static_cast<unsigned long long>(generation));
+	return (std::filesystem::path(directory) / name).string();
+}
+
+bool index_files::readManifest(const std::string& directory, Manifest& manifest)
+{
+	std::ifstream in(std::filesystem::path(directory) / "MANIFEST");
+	std::string key;
+	if (!in || !(in >> key >> manifest.version) || key != "version") {
+		return false;
+	}
+	manifest.segments.clear();
+	uint64_t segment;
+	while (in >> segment) {
+		manifest.segments.push_back(segment);
+	}
+	return true;
+}
+
+//     :     ,  
+void index_files::writeManifest(const std::string& directory, const Manifest& manifest)
+{
+	auto path = std::filesystem::path(directory) / "MANIFEST";
+	auto tmpPath = std::filesystem::path(directory) / "MANIFEST.tmp";
+	{
+		std::ofstream out(tmpPath, std::ios::trunc);
+		out << "version " << manifest.version << "\n";
+		for (uint64_t segment : manifest.segments) {
+			out << segment << "\n";
+		}
+		if (!out) {
+			throw std::runtime_error("    : " + tmpPath.string());
+		}
+	}
+	index_files::commitFile(tmpPath.string(), path.string());
+}
+
+namespace {
+
+//       
+bool syncFile(const std::string& path, bool directory)
+{
+#ifdef _WIN32
+	if (directory) {
+		return true; //   NTFS ,    
+	}
+	int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+	if (fd < 0) {
+		return false;
+	}
+	bool ok = _commit(fd) == 0;
+	_close(fd);
+	return ok;
+#else
+	int fd = ::open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDWR);
+	if (fd < 0) {
+		return false;
+	}
+	bool ok = ::fsync(fd) == 0;
+	::close(fd);
+	return ok;
+#endif
+}
+
+}
+
+void index_files::commitFile(const std::string& tmpPath, const std::string& path)
+{
+	if (!syncFile(tmpPath, false)) {
+		throw std::runtime_error("      : " + tmpPath);
+	}
+	std::filesystem::rename(tmpPath, path);
+	auto directory = std::filesystem::path(path).parent_path();
+	syncFile(directory.empty() ? "." : directory.string(), true); //      
+}
+
+std::vector<uint64_t> index_files::listSegments(const std::string& directory)
+{
+	std::vector<uint64_t> generations;
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+		std::string name = entry.path().filename().string();
+		unsigned long long generation = 0;
+		char tail = 0;
+		//   (.idx.tmp)     
+		if (std::sscanf(name.c_str(), "segment_%llu.id%c", &generation, &tail) == 2 && tail == 'x'
+			&& name.size() == segmentPath("", generation).size()) {
+			generations.push_back(generation);
+		}
+	}
+	std::sort(generations.begin(), generations.end());
+	return generations;
+}
+
+PostingCursor::PostingCursor(const char* data, uint64_t bytes, uint32_t docFreq)
+	: docFreq_(docFreq)
+{
+	std::memcpy(&blockCount_, data, sizeof(blockCount_));
+	blocks_ = reinterpret_cast<const BlockEntry*>(data + sizeof(blockCount_));
+	blockBase_ = reinterpret_cast<const uint8_t*>(blocks_ + blockCount_);
+	end_ = reinterpret_cast<const uint8_t*>(data) + bytes;
+	if (blockCount_ > 0) {
+		loadBlock(0);
+	}
+}
+
+void PostingCursor::loadBlock(uint32_t block)
+{
+	block_ = block;
+	count_ = std::min(blockSize, docFreq_ - block_ * blockSize);
+	pos_ = 0;
+
+	const uint8_t* p = blockBase_ + blocks_[block_].offset;
+	uint32_t doc = block_ > 0 ? blocks_[block_ - 1].lastDoc : 0;
+	for (uint32_t i = 0; i < count_; i++) {
+		doc += getVarint(p, end_);
+		docs_[i] = doc;
+	}
+	for (uint32_t i = 0; i < count_; i++) {
+		tfs_[i] = getVarint(p, end_);
+	}
+	positionData_ = p;
+	positionCursor_ = p;
+	positionIndex_ = 0;
+}
+
+void PostingCursor::next()
+{
+	if (++pos_ < count_) {
+		return;
+	}
+	if (block_ + 1 >= blockCount_) {
+		return; //  : valid() == false
+	}
+	loadBlock(block_ + 1);
+}
+
+void PostingCursor::advance(uint32_t target)
+{
+	if (!valid() || doc() >= target) {
+		return;
+	}
+
+	if (blocks_[block_].lastDoc < target) {
+		//   :  ,  lastDoc  target,   .
+		//    
+		uint32_t low = block_;
+		uint32_t step = 1;
+		while (low + step < blockCount_ && blocks_[low + step].lastDoc < target) {
+			low += step;
+			step *= 2;
+		}
+		uint32_t high = std::min(blockCount_, low + step + 1);
+		uint32_t block = static_cast<uint32_t>(std::partition_point(blocks_ + low, blocks_ + high,
+			[target](const BlockEntry& entry) { return entry.lastDoc < target; }) - blocks_);
+		if (block == blockCount_) {
+			pos_ = count_;
+			return;
+		}
+		loadBlock(block);
+	}
+
+	pos_ = static_cast<uint32_t>(std::lower_bound(docs_ + pos_, docs_ + count_, target) - docs_);
+}
+
+void PostingCursor::positions(std::vector<uint32_t>& out)
+{
+	if (positionIndex_ > pos_) {
+		positionCursor_ = positionData_;
+		positionIndex_ = 0;
+	}
+	//     
+	for (; positionIndex_ < pos_; positionIndex_++) {
+		for (uint32_t i = 0; i < tfs_[positionIndex_] && positionCursor_ < end_; i++) {
+			getVarint(positionCursor_, end_);
+		}
+	}
+
+	out.clear();
+	const uint8_t* p = positionCursor_;
+	uint32_t position = 0;
+	for (uint32_t i = 0; i < tfs_[pos_] && p < end_; i++) {
+		position += getVarint(p, end_);
+		out.push_back(position);
+	}
+}
+
+std::shared_ptr<Segment> Segment::open(const std::string& path, uint64_t generation)
+{
+	namespace bip = boost::interprocess;
+
+	std::shared_ptr<Segment> segment(new Segment());
+	segment->path_ = path;
+	segment->generation_ = generation;
+	segment->file_ = bip::file_mapping(path.c_str(), bip::read_only);
+	segment->region_ = bip::mapped_region(segment->file_, bip::read_only);
+	segment->base_ = static_cast<const char*>(segment->region_.get_address());
+
+	if (segment->region_.get_size() < sizeof(Header)) {
+		throw std::runtime_error("  : " + path);
+	}
+	segment->header_ = reinterpret_cast<const Header*>(segment->base_);
+	if (segment->header_->magic != magic || segment->header_->version != version) {
+		throw std::runtime_error("   : " + path);
+	}
+
+	segment->validate();
+
+	segment->dict_ = reinterpret_cast<const TermEntry*>(segment->base_ + segment->header_->dictOffset);
+	segment->strings_ = segment->base_ + segment->header_->stringsOffset;
+	segment->docs_ = reinterpret_cast<const DocEntry*>(segment->base_ + segment->header_->docsOffset);
+	segment->liveDocCount_ = static_cast<uint32_t>(std::count_if(segment->docs_, segment->docs_ + segment->header_->docCount,
+		[](const DocEntry& doc) { return doc.length > 0; }));
+	return segment;
+}
+
+//     :  , , ,  -  
+//   .      ,    :
+//      
+void Segment::validate() const
+{
+	const Header& header = *header_;
+	const uint64_t size = region_.get_size();
+	auto fail = [this](const char* what) {
+		throw std::runtime_error(std::string("   (") + what + "): " + path_);
+	};
+
+	if (header.dictOffset < sizeof(Header) || header.dictOffset > size
+		|| header.termCount > (size - header.dictOffset) / sizeof(TermEntry)) {
+		fail("");
+	}
+	if (header.stringsOffset != header.dictOffset + uint64_t(header.termCount) * sizeof(TermEntry)) {
+		fail(" ");
+	}
+	if (header.docsOffset < header.stringsOffset || header.docsOffset > size
+		|| header.docCount > (size - header.docsOffset) / sizeof(DocEntry)) {
+		fail("");
+	}
+
+	const uint64_t stringsBytes = header.docsOffset - header.stringsOffset;
+	const TermEntry* dict = reinterpret_cast<const TermEntry*>(base_ + header.dictOffset);
+	for (uint32_t i = 0; i < header.termCount; i++) {
+		const TermEntry& term = dict[i];
+		if (uint64_t(term.stringOffset) + term.stringLength > stringsBytes) {
+			fail(" ");
+		}
+		if (term.docFreq == 0 || term.postingsOffset < sizeof(Header) || term.postingsOffset > header.dictOffset
+			|| term.postingsBytes < sizeof(uint32_t) || term.postingsBytes > header.dictOffset - term.postingsOffset) {
+			fail(" ");
+		}
+
+		uint32_t blockCount;
+		std::memcpy(&blockCount, base_ + term.postingsOffset, sizeof(blockCount));
+		uint64_t tableBytes = sizeof(blockCount) + uint64_t(blockCount) * sizeof(BlockEntry);
+		if (blockCount != (uint64_t(term.docFreq) + blockSize - 1) / blockSize || tableBytes > term.postingsBytes) {
+			fail("");
+		}
+		const uint64_t dataBytes = term.postingsBytes - tableBytes;
+		const BlockEntry* blocks = reinterpret_cast<const BlockEntry*>(base_ + term.postingsOffset + sizeof(blockCount));
+		for (uint32_t b = 0; b < blockCount; b++) {
+			if (blocks[b].offset >= dataBytes || (b > 0 && blocks[b].offset <= blocks[b - 1].offset)) {
+				fail("");
+			}
+		}
+	}
+}
+
+std::string_view Segment::termText(const TermEntry& entry) const
+{
+	return std::string_view(strings_ + entry.stringOffset, entry.stringLength);
+}
+
+const TermEntry* Segment::find(std::string_view term) const
+{
+	const TermEntry* begin = dict_;
+	const TermEntry* end = dict_ + header_->termCount;
+	const TermEntry* it = std::lower_bound(begin, end, term, [this](const TermEntry& entry, std::string_view value) {
+		return termText(entry) < value;
+		});
+	if (it == end || termText(*it) != term) {
+		return nullptr;
+	}
+	return it;
+}
+
+PostingCursor Segment::postings(const TermEntry& entry) const
+{
+	return PostingCursor(base_ + entry.postingsOffset, entry.postingsBytes, entry.docFreq);
+}
+
+const DocEntry* Segment::findDoc(uint32_t docId) const
+{
+	const DocEntry* end = docs_ + header_->docCount;
+	const DocEntry* it = std::lower_bound(docs_, end, docId, [](const DocEntry& entry, uint32_t value) {
+		return entry.docId < value;
+		});
+	return it != end && it->docId == docId ? it : nullptr;
+}
+
+bool Segment::contains(uint32_t docId) const
+{
+	return findDoc(docId) != nullptr;
+}
+
+uint32_t Segment::docLength(uint32_t docId) const
+{
+	const DocEntry* doc = findDoc(docId);
+	return doc ? doc->length : 0;
+}
+
+void SegmentBuilder::add(uint32_t docId, const std::unordered_map<std::string, std::vector<uint32_t>>& wordPositions)
+{
+	uint32_t version = ++version_;
+	uint32_t length = 0;
+
+	for (const auto& [word, positions] : wordPositions) {
+		if (positions.empty()) {
+			continue;
+		}
+		auto [it, inserted] = terms_.try_emplace(word);
+		if (inserted) {
+			memory_ += sizeof(*it) + word.size() + 32;
+		}
+		uint32_t count = static_cast<uint32_t>(positions.size());
+		it->second.push_back({docId, count, version, positions_.size()});
+		positions_.insert(positions_.end(), positions.begin(), positions.end());
+		memory_ += sizeof(Entry) + count * sizeof(uint32_t);
+		length += count;
+	}
+
+	auto [doc, inserted] = docs_.try_emplace(docId);
+	if (inserted) {
+		memory_ += sizeof(*doc) + 16;
+	}
+	doc->second = {length, version};
+}
+
+void SegmentBuilder::clear()
+{
+	terms_.clear();
+	docs_.clear();
+	positions_.clear();
+	memory_ = 0;
+}
+
+void SegmentBuilder::write(const std::string& path) const
+{
+	std::vector<const std::string*> order;
+	order.reserve(terms_.size());
+	for (const auto& term : terms_) {
+		order.push_back(&term.first);
+	}
+	std::sort(order.begin(), order.end(), [](const std::string* a, const std::string* b) { return *a < *b; });
+
+	std::vector<DocEntry> docs;
+	docs.reserve(docs_.size());
+	for (const auto& [docId, doc] : docs_) {
+		docs.push_back({docId, doc.length});
+	}
+	std::sort(docs.begin(), docs.end(), [](const DocEntry& a, const DocEntry& b) { return a.docId < b.docId; });
+
+	SegmentFileWriter writer(path, std::move(docs));
+	std::vector<Posting> list;
+
+	for (const std::string* term : order) {
+		//    ,   
+		list.clear();
+		for (const Entry& entry : terms_.at(*term)) {
+			if (docs_.at(entry.docId).version == entry.version) {
+				list.push_back({entry.docId, entry.tf, entry.positions});
+			}
+		}
+		std::sort(list.begin(), list.end(), [](const Posting& a, const Posting& b) { return a.docId < b.docId; });
+		writer.addTerm(*term, list, positions_);
+	}
+	writer.finish();
+}
+
+SegmentFileWriter::SegmentFileWriter(const std::string& path, std::vector<DocEntry> docs)
+	: path_(path), docs_(std::move(docs)), tmpPath_(path + ".tmp"), out_(tmpPath_, std::ios::binary | std::ios::trunc)
+{
+	if (!out_) {
+		throw std::runtime_error("    : " + tmpPath_);
+	}
+	//    ,   
+	Header header{};
+	out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	offset_ = sizeof(header);
+}
+
+uint32_t SegmentFileWriter::docLength(uint32_t docId) const
+{
+	auto it = std::lower_bound(docs_.begin(), docs_.end(), docId, [](const DocEntry& entry, uint32_t value) {
+		return entry.docId < value;
+		});
+	return it != docs_.end() && it->docId == docId ? it->length : 0;
+}
+
+void SegmentFileWriter::addTerm(std::string_view term, const std::vector<Posting>& postings,
+	const std::vector<uint32_t>& positions)
+{
+	if (postings.empty()) {
+		return;
+	}
+
+	TermEntry entry{};
+	entry.stringOffset = static_cast<uint32_t>(strings_.size());
+	entry.stringLength = static_cast<uint32_t>(term.size());
+	entry.docFreq = static_cast<uint32_t>(postings.size());
+	entry.postingsOffset = offset_;
+	entry.minLength = UINT32_MAX;
+	strings_.append(term.data(), term.size());
+
+	blocks_.clear();
+	blockData_.clear();
+	uint32_t prev = 0;
+	for (size_t start = 0; start < postings.size(); start += blockSize) {
+		size_t end = std::min(postings.size(), start + blockSize);
+		BlockEntry block{0, 0, UINT32_MAX, blockData_.size()};
+		for (size_t i = start; i < end; i++) {
+			putVarint(blockData_, postings[i].docId - prev);
+			prev = postings[i].docId;
+			block.minLength = std::min(block.minLength, docLength(postings[i].docId));
+		}
+		for (size_t i = start; i < end; i++) {
+			putVarint(blockData_, postings[i].tf);
+			block.maxTf = std::max(block.maxTf, postings[i].tf);
+		}
+		for (size_t i = start; i < end; i++) {
+			uint32_t position = 0;
+			for (uint32_t j = 0; j < postings[i].tf; j++) {
+				uint32_t next = positions[postings[i].positions + j];
+				putVarint(blockData_, next - position);
+				position = next;
+			}
+		}
+		block.lastDoc = prev;
+		blocks_.push_back(block);
+
+		entry.maxTf = std::max(entry.maxTf, block.maxTf);
+		entry.minLength = std::min(entry.minLength, block.minLength);
+	}
+
+	uint32_t blockCount = static_cast<uint32_t>(blocks_.size());
+	out_.write(reinterpret_cast<const char*>(&blockCount), sizeof(blockCount));
+	out_.write(reinterpret_cast<const char*>(blocks_.data()), blocks_.size() * sizeof(BlockEntry));
+	out_.write(blockData_.data(), blockData_.size());
+
+	entry.postingsBytes = sizeof(blockCount) + blocks_.size() * sizeof(BlockEntry) + blockData_.size();
+	offset_ += entry.postingsBytes;
+	dict_.push_back(entry);
+}
+
+void SegmentFileWriter::finish()
+{
+	const auto& docs = docs_;
+	Header header{};
+	header.magic = magic;
+	header.version = version;
+	header.termCount = static_cast<uint32_t>(dict_.size());
+	header.docCount = static_cast<uint32_t>(docs.size());
+	for (const auto& doc : docs) {
+		header.totalLength += doc.length;
+	}
+	header.dictOffset = offset_;
+	header.stringsOffset = header.dictOffset + dict_.size() * sizeof(TermEntry);
+	header.docsOffset = header.stringsOffset + strings_.size();
+
+	out_.write(reinterpret_cast<const char*>(dict_.data()), dict_.size() * sizeof(TermEntry));
+	out_.write(strings_.data(), strings_.size());
+	out_.write(reinterpret_cast<const char*>(docs.data()), docs.size() * sizeof(DocEntry));
+	out_.seekp(0);
+	out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out_.close();
+	if (!out_) {
+		throw std::runtime_error("    : " + tmpPath_);
+	}
+
+	index_files::commitFile(tmpPath_, path_);
+}
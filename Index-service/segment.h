@@ -0,0 +1,241 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+//     ( ):
+//   Header |   |  TermEntry[termCount] |   | DocEntry[docCount]
+//    .    -   blockSize :
+//   uint32 blockCount | BlockEntry[blockCount] | 
+// :   ,  tf,      
+// (tf   ) -  varint.      
+//        tf    :
+//      BM25  
+namespace index_format {
+
+constexpr uint32_t magic = 0x58444E49; // "INDX"
+constexpr uint32_t version = 3;
+constexpr uint32_t blockSize = 128;
+
+#pragma pack(push, 1)
+struct Header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t termCount;
+	uint32_t docCount;
+	uint64_t totalLength;     //    ()
+	uint64_t dictOffset;
+	uint64_t stringsOffset;
+	uint64_t docsOffset;
+};
+
+struct TermEntry {
+	uint32_t stringOffset;
+	uint32_t stringLength;
+	uint32_t docFreq;
+	uint32_t maxTf;
+	uint32_t minLength;
+	uint64_t postingsOffset;
+	uint64_t postingsBytes;
+};
+
+struct BlockEntry {
+	uint32_t lastDoc;  //   :      
+	uint32_t maxTf;
+	uint32_t minLength;
+	uint64_t offset;   //      
+};
+
+struct DocEntry {
+	uint32_t docId;
+	uint32_t length;
+};
+#pragma pack(pop)
+
+}
+
+//    : segment_<>.idx  MANIFEST    
+//    .   (  )    
+namespace index_files {
+
+std::string segmentPath(const std::string& directory, uint64_t generation);
+std::vector<uint64_t> listSegments(const std::string& directory);
+
+struct Manifest {
+	uint64_t version = 0;
+	std::vector<uint64_t> segments;
+};
+
+bool readManifest(const std::string& directory, Manifest& manifest);
+void writeManifest(const std::string& directory, const Manifest& manifest);
+
+//       :  ,   .
+//            
+void commitFile(const std::string& tmpPath, const std::string& path);
+
+}
+
+//     :    
+class PostingCursor {
+public:
+	PostingCursor() = default;
+	// data -     bytes ,    
+	PostingCursor(const char* data, uint64_t bytes, uint32_t docFreq);
+
+	bool valid() const { return pos_ < count_; }
+	uint32_t doc() const { return docs_[pos_]; }
+	uint32_t tf() const { return tfs_[pos_]; }
+	uint32_t docFreq() const { return docFreq_; }
+
+	//        
+	uint32_t blockLastDoc() const { return blocks_[block_].lastDoc; }
+	uint32_t blockMaxTf() const { return blocks_[block_].maxTf; }
+	uint32_t blockMinLength() const { return blocks_[block_].minLength; }
+
+	void next();
+	//     >= target:   lastDoc ,     
+	void advance(uint32_t target);
+
+	//       
+	void positions(std::vector<uint32_t>& out);
+
+private:
+	const index_format::BlockEntry* blocks_ = nullptr;
+	const uint8_t* blockBase_ = nullptr;  //   
+	const uint8_t* end_ = nullptr;        //  :    
+	const uint8_t* positionData_ = nullptr;    //     
+	const uint8_t* positionCursor_ = nullptr;  //   positionIndex_
+	uint32_t positionIndex_ = 0;
+	uint32_t blockCount_ = 0;
+	uint32_t docFreq_ = 0;
+	uint32_t block_ = 0;
+	uint32_t pos_ = 0;
+	uint32_t count_ = 0;
+	uint32_t docs_[index_format::blockSize];
+	uint32_t tfs_[index_format::blockSize];
+
+	void loadBlock(uint32_t block);
+};
+
+// ,   :      .
+//          : 
+//    ,      
+class Segment {
+public:
+	static std::shared_ptr<Segment> open(const std::string& path, uint64_t generation);
+
+	uint64_t generation() const { return generation_; }
+	const std::string& path() const { return path_; }
+
+	uint32_t termCount() const { return header_->termCount; }
+	uint32_t docCount() const { return header_->docCount; }
+	//   :       
+	// (,  )    BM25  
+	uint32_t liveDocCount() const { return liveDocCount_; }
+	uint64_t totalLength() const { return header_->totalLength; }
+
+	const index_format::TermEntry* find(std::string_view term) const;
+	const index_format::TermEntry& termAt(uint32_t i) const { return dict_[i]; }
+	std::string_view termText(const index_format::TermEntry& entry) const;
+	PostingCursor postings(const index_format::TermEntry& entry) const;
+
+	size_t bytes() const { return region_.get_size(); }
+
+	const index_format::DocEntry* docs() const { return docs_; }
+	bool contains(uint32_t docId) const;
+	uint32_t docLength(uint32_t docId) const;
+
+	Segment(const Segment&) = delete;
+	Segment& operator=(const Segment&) = delete;
+
+private:
+	Segment() = default;
+
+	std::string path_;
+	uint64_t generation_ = 0;
+	boost::interprocess::file_mapping file_;
+	boost::interprocess::mapped_region region_;
+	const char* base_ = nullptr;
+	const index_format::Header* header_ = nullptr;
+	const index_format::TermEntry* dict_ = nullptr;
+	const char* strings_ = nullptr;
+	const index_format::DocEntry* docs_ = nullptr;
+	uint32_t liveDocCount_ = 0;
+
+	const index_format::DocEntry* findDoc(uint32_t docId) const;
+	void validate() const;
+};
+
+struct Posting {
+	uint32_t docId;
+	uint32_t tf;
+	size_t positions;  //  tf       
+};
+
+//    :    ,
+//      ,     
+class SegmentFileWriter {
+public:
+	// docs   docId     
+	SegmentFileWriter(const std::string& path, std::vector<index_format::DocEntry> docs);
+
+	// postings   docId,     positions
+	void addTerm(std::string_view term, const std::vector<Posting>& postings, const std::vector<uint32_t>& positions);
+	//      finish
+	void finish();
+
+private:
+	std::string path_;
+	std::vector<index_format::DocEntry> docs_;
+	std::string tmpPath_;
+	std::ofstream out_;
+	uint64_t offset_ = 0;
+	std::vector<index_format::TermEntry> dict_;
+	std::string strings_;
+	std::vector<index_format::BlockEntry> blocks_;
+	std::string blockData_;
+
+	uint32_t docLength(uint32_t docId) const;
+};
+
+//   :       .
+//      
+class SegmentBuilder {
+public:
+	//    -       
+	void add(uint32_t docId, const std::unordered_map<std::string, std::vector<uint32_t>>& wordPositions);
+
+	bool empty() const { return docs_.empty(); }
+	size_t docCount() const { return docs_.size(); }
+	size_t memory() const { return memory_; }
+
+	//      :     
+	void write(const std::string& path) const;
+	void clear();
+
+private:
+	struct Entry {
+		uint32_t docId;
+		uint32_t tf;
+		uint32_t version;  //   :    
+		size_t positions;  //    positions_
+	};
+	struct Doc {
+		uint32_t length;
+		uint32_t version;
+	};
+
+	std::unordered_map<std::string, std::vector<Entry>> terms_;
+	std::unordered_map<uint32_t, Doc> docs_;
+	std::vector<uint32_t> positions_;
+	uint32_t version_ = 0;
+	size_t memory_ = 0;
+};
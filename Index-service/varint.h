@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//    :  7   ,   -  
+
+inline void putVarint(std::string& out, uint32_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<char>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+//     end:       ,
+//    
+inline uint32_t getVarint(const uint8_t*& p, const uint8_t* end)
+{
+	uint32_t value = 0;
+	int shift = 0;
+	while (p < end) {
+		uint8_t byte = *p++;
+		if (shift < 32) {
+			value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		}
+		shift += 7;
+		if ((byte & 0x80) == 0) {
+			break;
+		}
+	}
+	return value;
+}
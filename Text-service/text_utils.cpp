@@ -0,0 +1,338 @@
+#include "text_utils.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TEXT_KERNEL_X86
+#include <immintrin.h>
+#if !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#define TEXT_TARGET_AVX2
+#else
+#define TEXT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+//     
+enum : uint8_t { WordBit = 1, DigitBit = 2, UpperBit = 4 };
+
+struct ByteClasses {
+	uint8_t table[256];
+
+	ByteClasses() {
+		for (int c = 0; c < 256; c++) {
+			uint8_t cls = 0;
+			if ((c >= 'a' && c <= 'z') || c >= 0x80) {
+				cls = WordBit;
+			}
+			else if (c >= 'A' && c <= 'Z') {
+				cls = WordBit | UpperBit;
+			}
+			else if ((c >= '0' && c <= '9') || c == '_') {
+				cls = WordBit | DigitBit;
+			}
+			table[c] = cls;
+		}
+	}
+};
+
+const ByteClasses byteClasses;
+
+void setBit(uint64_t* mask, size_t i)
+{
+	mask[i / 64] |= 1ull << (i % 64);
+}
+
+void classifyScalar(const char* src, char* dst, size_t begin, size_t n,
+	uint64_t* wordMask, uint64_t* digitMask, uint64_t* nonAsciiMask)
+{
+	for (size_t i = begin; i < n; i++) {
+		unsigned char c = static_cast<unsigned char>(src[i]);
+		uint8_t cls = byteClasses.table[c];
+		dst[i] = static_cast<char>((cls & UpperBit) ? c + ('a' - 'A') : c);
+		if (cls & WordBit) {
+			setBit(wordMask, i);
+		}
+		if (cls & DigitBit) {
+			setBit(digitMask, i);
+		}
+		if (c >= 0x80) {
+			setBit(nonAsciiMask, i);
+		}
+	}
+}
+
+void lowerAndClassifyScalar(const char* src, char* dst, size_t n,
+	uint64_t* wordMask, uint64_t* digitMask, uint64_t* nonAsciiMask)
+{
+	classifyScalar(src, dst, 0, n, wordMask, digitMask, nonAsciiMask);
+}
+
+#ifdef TEXT_KERNEL_X86
+
+//     width ,    i (i  width)
+inline void storeMask(uint64_t* mask, size_t i, uint64_t bits)
+{
+	mask[i / 64] |= bits << (i % 64);
+}
+
+void lowerAndClassifySse2(const char* src, char* dst, size_t n,
+	uint64_t* wordMask, uint64_t* digitMask, uint64_t* nonAsciiMask)
+{
+	const __m128i upperLo = _mm_set1_epi8('A' - 1);
+	const __m128i upperHi = _mm_set1_epi8('Z' + 1);
+	const __m128i lowerLo = _mm_set1_epi8('a' - 1);
+	const __m128i lowerHi = _mm_set1_epi8('z' + 1);
+	const __m128i digitLo = _mm_set1_epi8('0' - 1);
+	const __m128i digitHi = _mm_set1_epi8('9' + 1);
+	const __m128i underscore = _mm_set1_epi8('_');
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		//  -ASCII         
+		__m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, upperLo), _mm_cmplt_epi8(v, upperHi));
+		__m128i lower = _mm_or_si128(v, _mm_and_si128(upper, caseBit));
+		__m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, lowerLo), _mm_cmplt_epi8(lower, lowerHi));
+		__m128i digit = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi8(v, digitLo), _mm_cmplt_epi8(v, digitHi)),
+			_mm_cmpeq_epi8(v, underscore));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), lower);
+
+		uint64_t nonAscii = static_cast<uint32_t>(_mm_movemask_epi8(v));
+		uint64_t digits = static_cast<uint32_t>(_mm_movemask_epi8(digit));
+		uint64_t letters = static_cast<uint32_t>(_mm_movemask_epi8(letter));
+		storeMask(wordMask, i, letters | digits | nonAscii);
+		storeMask(digitMask, i, digits);
+		storeMask(nonAsciiMask, i, nonAscii);
+	}
+	classifyScalar(src, dst, i, n, wordMask, digitMask, nonAsciiMask);
+}
+
+TEXT_TARGET_AVX2
+void lowerAndClassifyAvx2(const char* src, char* dst, size_t n,
+	uint64_t* wordMask, uint64_t* digitMask, uint64_t* nonAsciiMask)
+{
+	const __m256i upperLo = _mm256_set1_epi8('A' - 1);
+	const __m256i upperHi = _mm256_set1_epi8('Z' + 1);
+	const __m256i lowerLo = _mm256_set1_epi8('a' - 1);
+	const __m256i lowerHi = _mm256_set1_epi8('z' + 1);
+	const __m256i digitLo = _mm256_set1_epi8('0' - 1);
+	const __m256i digitHi = _mm256_set1_epi8('9' + 1);
+	const __m256i underscore = _mm256_set1_epi8('_');
+	const __m256i caseBit = _mm256_set1_epi8(0x20);
+
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		__m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, upperLo), _mm256_cmpgt_epi8(upperHi, v));
+		__m256i lower = _mm256_or_si256(v, _mm256_and_si256(upper, caseBit));
+		__m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, lowerLo), _mm256_cmpgt_epi8(lowerHi, lower));
+		__m256i digit = _mm256_or_si256(
+			_mm256_and_si256(_mm256_cmpgt_epi8(v, digitLo), _mm256_cmpgt_epi8(digitHi, v)),
+			_mm256_cmpeq_epi8(v, underscore));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), lower);
+
+		uint64_t nonAscii = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+		uint64_t digits = static_cast<uint32_t>(_mm256_movemask_epi8(digit));
+		uint64_t letters = static_cast<uint32_t>(_mm256_movemask_epi8(letter));
+		storeMask(wordMask, i, letters | digits | nonAscii);
+		storeMask(digitMask, i, digits);
+		storeMask(nonAsciiMask, i, nonAscii);
+	}
+	classifyScalar(src, dst, i, n, wordMask, digitMask, nonAsciiMask);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+using Kernel = void (*)(const char*, char*, size_t, uint64_t*, uint64_t*, uint64_t*);
+
+struct KernelChoice {
+	Kernel kernel = lowerAndClassifyScalar;
+	const char* name = "scalar";
+
+	KernelChoice() {
+#ifdef TEXT_KERNEL_X86
+		if (cpuHasAvx2()) {
+			kernel = lowerAndClassifyAvx2;
+			name = "avx2";
+		}
+		else {
+			// SSE2     x86-64
+			kernel = lowerAndClassifySse2;
+			name = "sse2";
+		}
+#endif
+	}
+};
+
+const KernelChoice& kernelChoice()
+{
+	static const KernelChoice choice;
+	return choice;
+}
+
+//    UTF-8;    0   pos  
+char32_t decodeUtf8(std::string_view s, size_t& pos)
+{
+	unsigned char c = static_cast<unsigned char>(s[pos]);
+	size_t length;
+	char32_t cp;
+	if (c < 0x80) {
+		pos++;
+		return c;
+	}
+	else if ((c & 0xE0) == 0xC0) {
+		length = 2;
+		cp = c & 0x1F;
+	}
+	else if ((c & 0xF0) == 0xE0) {
+		length = 3;
+		cp = c & 0x0F;
+	}
+	else if ((c & 0xF8) == 0xF0) {
+		length = 4;
+		cp = c & 0x07;
+	}
+	else {
+		pos++;
+		return 0;
+	}
+
+	if (pos + length > s.size()) {
+		pos++;
+		return 0;
+	}
+	for (size_t i = 1; i < length; i++) {
+		unsigned char next = static_cast<unsigned char>(s[pos + i]);
+		if ((next & 0xC0) != 0x80) {
+			pos++;
+			return 0;
+		}
+		cp = (cp << 6) | (next & 0x3F);
+	}
+	pos += length;
+	return cp;
+}
+
+void encodeUtf8(char32_t cp, std::string& out)
+{
+	if (cp < 0x80) {
+		out += static_cast<char>(cp);
+	}
+	else if (cp < 0x800) {
+		out += static_cast<char>(0xC0 | (cp >> 6));
+		out += static_cast<char>(0x80 | (cp & 0x3F));
+	}
+	else if (cp < 0x10000) {
+		out += static_cast<char>(0xE0 | (cp >> 12));
+		out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		out += static_cast<char>(0x80 | (cp & 0x3F));
+	}
+	else {
+		out += static_cast<char>(0xF0 | (cp >> 18));
+		out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+		out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+		out += static_cast<char>(0x80 | (cp & 0x3F));
+	}
+}
+
+//  ,    
+bool isLetter(char32_t cp)
+{
+	return (cp >= 'a' && cp <= 'z')
+		|| (cp >= 'A' && cp <= 'Z')
+		|| (cp >= 0x00C0 && cp <= 0x024F && cp != 0x00D7 && cp != 0x00F7)
+		|| (cp >= 0x0386 && cp <= 0x03FF)
+		|| (cp >= 0x0400 && cp <= 0x052F);
+}
+
+char32_t toLowerCodepoint(char32_t cp)
+{
+	if (cp >= 'A' && cp <= 'Z') {
+		return cp + 0x20;
+	}
+	if ((cp >= 0x00C0 && cp <= 0x00DE && cp != 0x00D7)
+		|| (cp >= 0x0391 && cp <= 0x03AB && cp != 0x03A2)
+		|| (cp >= 0x0410 && cp <= 0x042F)) {
+		return cp + 0x20;
+	}
+	if (cp >= 0x0400 && cp <= 0x040F) {
+		return cp + 0x50;
+	}
+	// -A   :     
+	if (((cp >= 0x0100 && cp <= 0x0137) || (cp >= 0x014A && cp <= 0x0177)
+		|| (cp >= 0x0460 && cp <= 0x0481) || (cp >= 0x048A && cp <= 0x04BF)
+		|| (cp >= 0x04D0 && cp <= 0x052F)) && cp % 2 == 0) {
+		return cp + 1;
+	}
+	if (((cp >= 0x0139 && cp <= 0x0148) || (cp >= 0x0179 && cp <= 0x017E)
+		|| (cp >= 0x04C1 && cp <= 0x04CE)) && cp % 2 == 1) {
+		return cp + 1;
+	}
+	return cp;
+}
+
+}
+
+void lowerAndClassify(const char* src, char* dst, size_t n,
+	uint64_t* wordMask, uint64_t* digitMask, uint64_t* nonAsciiMask)
+{
+	kernelChoice().kernel(src, dst, n, wordMask, digitMask, nonAsciiMask);
+}
+
+const char* textKernelName()
+{
+	return kernelChoice().name;
+}
+
+bool WordSplitter::nextUtf8Word(std::string_view run, size_t& pos)
+{
+	while (pos < run.size()) {
+		utf8Word_.clear();
+		bool valid = true;
+
+		//     ,   ,   '_'
+		while (pos < run.size()) {
+			char32_t cp = decodeUtf8(run, pos);
+			if (isLetter(cp)) {
+				encodeUtf8(toLowerCodepoint(cp), utf8Word_);
+			}
+			else if ((cp >= '0' && cp <= '9') || cp == '_') {
+				valid = false;
+			}
+			else {
+				break; //  ( ,    ..)
+			}
+		}
+
+		if (valid && !utf8Word_.empty()) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline unsigned countTrailingZeros(uint64_t x)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return static_cast<unsigned>(index);
+#else
+	return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+//  ASCII- src     dst      n :
+// wordMask -   ( , , '_'   -ASCII),
+// digitMask -   '_', nonAsciiMask -  -ASCII.
+//  (AVX2, SSE2  )       
+void lowerAndClassify(const char* src, char* dst, size_t n,
+	uint64_t* wordMask, uint64_t* digitMask, uint64_t* nonAsciiMask);
+
+//     ("avx2", "sse2"  "scalar")
+const char* textKernelName();
+
+//   UTF-8     .  
+//  ,      '_'. ASCII 
+//  ,   UTF-8     -ASCII
+class WordSplitter {
+public:
+	template <class F>
+	void split(std::string_view text, F&& onWord);
+
+private:
+	std::string lower_;
+	std::vector<uint64_t> word_;
+	std::vector<uint64_t> digit_;
+	std::vector<uint64_t> nonAscii_;
+	std::string utf8Word_;
+
+	//     -ASCII:  onWord    
+	template <class F>
+	void splitUtf8(std::string_view run, F&& onWord);
+
+	//    [pos, run.size()); false,    
+	bool nextUtf8Word(std::string_view run, size_t& pos);
+};
+
+template <class F>
+void WordSplitter::split(std::string_view text, F&& onWord)
+{
+	const size_t n = text.size();
+	const size_t blocks = (n + 63) / 64;
+	lower_.resize(n);
+	word_.assign(blocks, 0);
+	digit_.assign(blocks, 0);
+	nonAscii_.assign(blocks, 0);
+
+	lowerAndClassify(text.data(), &lower_[0], n, word_.data(), digit_.data(), nonAscii_.data());
+
+	size_t pos = 0;
+	while (pos < n) {
+		//      
+		size_t block = pos / 64;
+		uint64_t bits = word_[block] & (~0ull << (pos % 64));
+		while (bits == 0 && ++block < blocks) {
+			bits = word_[block];
+		}
+		if (bits == 0) {
+			break;
+		}
+		size_t start = block * 64 + countTrailingZeros(bits);
+
+		//  :  ,    
+		block = start / 64;
+		bits = ~word_[block] & (~0ull << (start % 64));
+		while (bits == 0 && ++block < blocks) {
+			bits = ~word_[block];
+		}
+		size_t end = bits == 0 ? n : std::min(n, block * 64 + countTrailingZeros(bits));
+
+		bool hasDigit = false;
+		bool hasNonAscii = false;
+		for (size_t b = start / 64; b <= (end - 1) / 64; b++) {
+			uint64_t range = ~0ull;
+			if (b == start / 64) {
+				range &= ~0ull << (start % 64);
+			}
+			if (b == (end - 1) / 64 && end % 64 != 0) {
+				range &= ~0ull >> (64 - end % 64);
+			}
+			hasDigit = hasDigit || (digit_[b] & range) != 0;
+			hasNonAscii = hasNonAscii || (nonAscii_[b] & range) != 0;
+		}
+
+		if (hasNonAscii) {
+			splitUtf8(std::string_view(lower_).substr(start, end - start), onWord);
+		}
+		else if (!hasDigit) {
+			onWord(std::string_view(lower_).substr(start, end - start));
+		}
+		pos = end;
+	}
+}
+
+template <class F>
+void WordSplitter::splitUtf8(std::string_view run, F&& onWord)
+{
+	size_t pos = 0;
+	while (nextUtf8Word(run, pos)) {
+		onWord(std::string_view(utf8Word_));
+	}
+}
@@ -0,0 +1,120 @@
+//   :  getWords  (boost::locale::to_lower  
+// )  WordSplitter   .  -   ASCII,
+//           .
+//   WordsBench [ , ] []
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include <random>
+
+#include <boost/locale.hpp>
+#include <boost/regex.hpp>
+
+#include "text_utils.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using WordCounts = std::unordered_map<std::string, int>;
+
+// getWords   ,    
+void legacyGetWords(WordCounts& wordsCount, const std::string& html)
+{
+	std::string text = boost::regex_replace(html, boost::regex(R"(<[^>]+>)"), " ");
+	text = boost::locale::to_lower(text, boost::locale::generator().generate(""));
+
+	boost::regex expression(R"(\b[a-zA-Z]+\b)");
+	boost::sregex_iterator it(text.begin(), text.end(), expression);
+	boost::sregex_iterator end;
+	while (it != end) {
+		wordsCount[it->str()]++;
+		++it;
+	}
+}
+
+void splitterGetWords(WordSplitter& splitter, WordCounts& wordsCount, const std::string& text)
+{
+	splitter.split(text, [&](std::string_view word) {
+		wordsCount[std::string(word)]++;
+		});
+}
+
+//     , ,      
+std::string generateText(size_t bytes)
+{
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> length(1, 12);
+	std::uniform_int_distribution<int> letter(0, 25);
+	std::uniform_int_distribution<int> kind(0, 19);
+	static const char* separators[] = {" ", " ", " ", ", ", ". ", "\n", " - ", "; "};
+
+	std::string text;
+	text.reserve(bytes + 32);
+	while (text.size() < bytes) {
+		int k = kind(random);
+		int n = length(random);
+		for (int i = 0; i < n; i++) {
+			char c = static_cast<char>('a' + letter(random));
+			text += i == 0 && k < 4 ? static_cast<char>(c - 'a' + 'A') : c;
+		}
+		if (k == 19) {
+			text += std::to_string(letter(random)); // ,   ,   
+		}
+		text += separators[k % 8];
+	}
+	return text;
+}
+
+template <class F>
+double measure(int repeats, size_t bytes, F&& run)
+{
+	auto started = Clock::now();
+	for (int i = 0; i < repeats; i++) {
+		run();
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+	return bytes * static_cast<double>(repeats) / seconds / (1024 * 1024);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	size_t kilobytes = argc > 1 ? std::stoul(argv[1]) : 1536;
+	int repeats = argc > 2 ? std::stoi(argv[2]) : 5;
+	std::string text = generateText(kilobytes * 1024);
+
+	WordCounts legacy;
+	WordCounts current;
+	WordSplitter splitter;
+	double legacySpeed = measure(repeats, text.size(), [&] {
+		legacy.clear();
+		legacyGetWords(legacy, text);
+		});
+	double currentSpeed = measure(repeats, text.size(), [&] {
+		current.clear();
+		splitterGetWords(splitter, current, text);
+		});
+	//    -:   
+	size_t words = 0;
+	double splitSpeed = measure(repeats, text.size(), [&] {
+		words = 0;
+		splitter.split(text, [&](std::string_view) { words++; });
+		});
+
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << text.size() / 1024 << " KB x " << repeats << ", " << current.size() << " distinct words" << std::endl;
+	std::cout << "legacy getWords: " << legacySpeed << " MB/s" << std::endl;
+	std::cout << "WordSplitter (" << textKernelName() << "): " << currentSpeed << " MB/s, "
+		<< currentSpeed / legacySpeed << "x" << std::endl;
+	std::cout << "WordSplitter without counting: " << splitSpeed << " MB/s, " << words << " words" << std::endl;
+
+	if (legacy != current) {
+		std::cout << "word counts differ" << std::endl;
+		return 1;
+	}
+	return 0;
+}